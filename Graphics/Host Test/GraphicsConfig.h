@@ -0,0 +1,48 @@
+/*********************************************************************
+ * Module for Microchip Graphics Library
+ * This file contains compile time options for the Graphics Library.
+ *********************************************************************
+ * FileName:        GraphicsConfig.h
+ * Processor:       host PC
+ * Compiler:        gcc
+ * Company:         TechToys Company
+ *
+ * Software License Agreement
+ *
+ * You should refer to the license agreement accompanying this
+ * Software for additional information regarding your rights and
+ * obligations.
+ *
+ ********************************************************************/
+#ifndef _GRAPHICSCONFIG_H
+    #define _GRAPHICSCONFIG_H
+
+/*********************************************************************
+* Overview: Define the malloc() and free() for versatility on OS
+*           based systems.
+*
+*********************************************************************/
+#define GFX_malloc(size)    	malloc(size)
+#define GFX_free(pObj)    	free(pObj)
+
+/*********************************************************************
+* Overview: The driver options of the Primitive Demo GraphicsConfig.h.
+*           The board options of its HardwareProfile.h are not all
+*           here: the host HardwareProfile.h leaves out TE sync, the
+*           PWM backlight and PMP interrupt transfers, which the bus
+*           model does not cover.
+*
+*********************************************************************/
+#ifndef COLOR_DEPTH
+#define COLOR_DEPTH             16
+#endif
+
+#define USE_SSD2805_FRAME_SCHEDULER
+#define SSD2805_FRAME_RATE      30
+
+// make warnings also builds the driver without them
+#ifndef NO_SSD2805_PERF_COUNTERS
+#define USE_SSD2805_PERF_COUNTERS
+#endif
+
+#endif // _GRAPHICSCONFIG_H
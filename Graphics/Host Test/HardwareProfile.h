@@ -0,0 +1,116 @@
+/*********************************************************************
+ *
+ *	Hardware specific definitions
+ *
+ *********************************************************************
+ * FileName:        HardwareProfile.h
+ * Processor:       host PC
+ * Compiler:        gcc
+ * Company:         TechToys Company
+ *
+ * Software License Agreement
+ *
+ * You should refer to the license agreement accompanying this
+ * Software for additional information regarding your rights and
+ * obligations.
+ *
+ ********************************************************************/
+/*
+*********************************************************************
+* Hardware profile for the host build of SSD2805.c
+* The PIC32MX250F128D board of Primitive Demo with the LH154Q01 panel
+* in command mode, the 8080 bus goes to the SSD2805 model of
+* SSD2805Model.c instead of the PMP. 8-bit PMP unless USE_16BIT_PMP
+* is given on the command line. TE sync, PWM backlight and PMP
+* interrupt transfers are not modelled and stay off.
+*********************************************************************
+*/
+#ifndef __HARDWARE_PROFILE_H
+    #define __HARDWARE_PROFILE_H
+
+/*********************************************************************
+* PIC Device Specific includes
+*********************************************************************/
+    #include "Compiler.h"
+    #include "SSD2805Model.h"
+
+/*********************************************************************
+* Clocks of the PIC32MX250F128D board, PBDIV 1
+********************************************************************/
+    #define GetSystemClock()        (40000000ul)
+    #define GetPeripheralClock()    (GetSystemClock())
+    #define GetInstructionClock()   (GetSystemClock())
+
+/* ################################################################## */
+/*********************************************************************
+* START OF GRAPHICS RELATED MACROS
+********************************************************************/
+/* ################################################################## */
+
+#define GFX_USE_SSD2805_MIPI_BRIDGE
+#define USE_GFX_PMP
+#define USE_SSD2805_CMD_MODE
+#if !defined (USE_16BIT_PMP)
+#define USE_8BIT_PMP
+#endif
+
+#define GFX_USE_DISPLAY_PANEL_TFT_LH154Q01	//LG 1.54" TFT in 1-lane Mipi interface 240x240
+
+#if defined (GFX_USE_DISPLAY_PANEL_TFT_LH154Q01)
+	#define DISP_ORIENTATION    0
+    #define DISP_HOR_RESOLUTION 240
+    #define DISP_VER_RESOLUTION 240
+    #define GFX_LCD_TYPE            GFX_LCD_TFT
+#endif
+
+/*********************************************************************
+* HARDWARE PROFILE FOR DISPLAY CONTROLLER INTERFACE
+*********************************************************************/
+	    #define BACKLIGHT_ENABLE_LEVEL      1
+	    #define BACKLIGHT_DISABLE_LEVEL     0
+
+		// power and backlight switches have no effect on the model
+		#define SSD_PowerConfig()
+		#define SSD_PowerOn()
+		#define SSD_PowerOff()
+		#define LH_PowerConfig()
+		#define LH_PowerOn()
+		#define LH_PowerOff()
+		#define DisplayBacklightConfig()
+		#define DisplayBacklightOn()
+		#define DisplayBacklightOff()
+
+		// RESET low returns SSD2805 and the panel to their power-on state
+		#define SSD_ResetConfig()
+		#define SSD_ResetEnable()		SSD2805ModelReset()
+		#define SSD_ResetDisable()
+		#define DisplayResetConfig()    SSD_ResetConfig()
+		#define DisplayResetEnable()    SSD_ResetEnable()
+		#define DisplayResetDisable()   SSD_ResetDisable()
+
+		// -----------------------------------
+		// SSD2805 clock configuration, same as Primitive Demo
+		// -----------------------------------
+		#define SSD_TX_CLK_MHZ              20
+		#define SSD_HS_LANE_MBPS            320
+		#define SSD_PLL_PDIV                1
+		#define SSD_PLL_DIV                 1
+		#define SSD_LP_DIV                  5
+		#define SSD_SYS_CLK_DIV             2
+
+		#define PMP_DATA_SETUP_TIME	(18)
+		#define PMP_DATA_WAIT_TIME	(82)
+		#define PMP_DATA_HOLD_TIME	(0)
+
+		// chip select, SDC (PMA0) and the bus cycles go to the model
+		#define DisplayCmdDataConfig()
+		#define DisplaySetCommand()         SSD2805ModelSetDC(0)
+		#define DisplaySetData()            SSD2805ModelSetDC(1)
+		#define DisplayConfig()
+		#define DisplayEnable()             SSD2805ModelSelect(1)
+		#define DisplayDisable()            SSD2805ModelSelect(0)
+		#define DeviceWrite(data)           SSD2805ModelWrite(data)
+		#define DeviceRead()                SSD2805ModelRead()
+		#define PMPWaitBusy()
+
+#endif // __HARDWARE_PROFILE_H
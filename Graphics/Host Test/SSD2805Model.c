@@ -0,0 +1,569 @@
+/*********************************************************************
+ *
+ *	SSD2805 and LH154Q01 bus model for the host build
+ *
+ *********************************************************************
+ * FileName:        SSD2805Model.c
+ * Processor:       host PC
+ * Compiler:        gcc
+ * Company:         TechToys Company
+ *
+ * Software License Agreement
+ *
+ * You should refer to the license agreement accompanying this
+ * Software for additional information regarding your rights and
+ * obligations.
+ *
+ ********************************************************************/
+#include <string.h>
+#include "HardwareProfile.h"
+#include "SSD2805Model.h"
+
+#if defined (USE_16BIT_PMP)
+#define MODEL_BUS_BYTES         2
+#else
+#define MODEL_BUS_BYTES         1
+#endif
+
+// what the data cycles after the last command cycle go to
+#define MODEL_MODE_NONE         0       // no command yet, or a read request
+#define MODEL_MODE_REG          1       // local register value
+#define MODEL_MODE_READ_DATA    2       // 0xD7, read buffer
+#define MODEL_MODE_PACKET       3       // TDC bytes to the panel
+
+// 0xC6 status bits
+#define MODEL_ISR_RDR           0x0001  // read data ready
+#define MODEL_ISR_PLS           0x0080  // PLL locked
+
+// SFRs of p32xxxx.h
+volatile unsigned int   PMMODE;
+volatile __PMMODEbits_t PMMODEbits;
+volatile unsigned int   PMCON;
+volatile __PMCONbits_t  PMCONbits;
+volatile unsigned int   PMAEN;
+volatile __PMAENbits_t  PMAENbits;
+volatile unsigned int   PMADDR;
+volatile unsigned int   PMDIN;
+
+static unsigned int         _ticks;
+static SSD2805_MODEL_STATS  _stats;
+
+// SSD2805
+static WORD     _reg[0x100];            // local registers, 0xB0-0xD9 used
+static BYTE     _selected;
+static BYTE     _dc;
+static BYTE     _cmd;                   // last command cycle
+static BYTE     _mode;                  // MODEL_MODE_xxx
+static BYTE     _regBytes;              // bytes of a register value on the 8-bit bus
+#if !defined (USE_16BIT_PMP)
+static WORD     _regValue;
+#endif
+static BYTE     _readHigh;              // next register read returns the high byte
+static DWORD    _tdc;                   // TDC of the packet in progress
+static DWORD    _packetBytes;           // bytes of the packet received so far
+static BYTE     _param[8];              // parameters of a short DCS packet
+static BYTE     _readBuf[256];          // return packet of a DCS read
+static WORD     _readCount;
+static WORD     _readPos;
+static BYTE     _readReady;
+
+// panel
+static DWORD    _gram[SSD2805_MODEL_HEIGHT][SSD2805_MODEL_WIDTH];
+static WORD     _colStart, _colEnd, _pageStart, _pageEnd;
+static WORD     _col, _page;            // memory access pointer
+static BYTE     _madctl;
+static BYTE     _pixelFormat;
+static BYTE     _pixel[3];              // bytes of the pixel being written
+static BYTE     _pixelCount;
+
+/*********************************************************************
+* Function: static BYTE ModelPixelBytes(void)
+*
+* Overview: bytes per pixel of the pixel format set with 0x3A
+*
+********************************************************************/
+static BYTE ModelPixelBytes(void)
+{
+    return ((_pixelFormat == 0x05)? 2 : 3);
+}
+
+/*********************************************************************
+* Function: static DWORD *ModelCursor(void)
+*
+* Overview: maps the memory access pointer through MADCTL to a GRAM
+*			cell, NULL if it is outside the panel
+*
+********************************************************************/
+static DWORD *ModelCursor(void)
+{
+    WORD c = _col, p = _page, x, y;
+
+    if(_madctl & 0x40)                  // MX
+        c = ((_madctl & 0x20)? SSD2805_MODEL_HEIGHT : SSD2805_MODEL_WIDTH) - 1 - c;
+    if(_madctl & 0x80)                  // MY
+        p = ((_madctl & 0x20)? SSD2805_MODEL_WIDTH : SSD2805_MODEL_HEIGHT) - 1 - p;
+    if(_madctl & 0x20)                  // MV
+    {
+        x = p;
+        y = c;
+    }
+    else
+    {
+        x = c;
+        y = p;
+    }
+    if((x >= SSD2805_MODEL_WIDTH) || (y >= SSD2805_MODEL_HEIGHT))
+        return (NULL);
+    return (&_gram[y][x]);
+}
+
+/*********************************************************************
+* Function: static void ModelAdvance(void)
+*
+* Overview: moves the memory access pointer to the next pixel of the
+*			window, row by row, wrapping at the end
+*
+********************************************************************/
+static void ModelAdvance(void)
+{
+    if(++_col > _colEnd)
+    {
+        _col = _colStart;
+        if(++_page > _pageEnd)
+            _page = _pageStart;
+    }
+}
+
+/*********************************************************************
+* Function: static void ModelStorePixel(void)
+*
+* Overview: writes the received pixel bytes at the memory access
+*			pointer: RGB565 lower byte first, or R, G, B as a DCS
+*			memory write takes them (B, G, R with
+*			SSD2805_PIXEL_ORDER_BGR)
+*
+********************************************************************/
+static void ModelStorePixel(void)
+{
+    DWORD *pCell = ModelCursor();
+    DWORD rgb, r, g, b;
+
+    if(ModelPixelBytes() == 2)
+    {
+        WORD v = ((WORD)_pixel[1] << 8) | _pixel[0];
+
+        r = (v >> 11) & 0x1F;
+        g = (v >> 5) & 0x3F;
+        b = v & 0x1F;
+        rgb = (((r << 3) | (r >> 2)) << 16) | (((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2));
+    }
+    else
+    {
+    #if defined (SSD2805_PIXEL_ORDER_BGR)
+        rgb = ((DWORD)_pixel[2] << 16) | ((DWORD)_pixel[1] << 8) | _pixel[0];
+    #else
+        rgb = ((DWORD)_pixel[0] << 16) | ((DWORD)_pixel[1] << 8) | _pixel[2];
+    #endif
+        if(_pixelFormat == 0x06)
+            rgb &= 0x00FCFCFC;          // 18-bit, two low bits per color are not stored
+    }
+
+    if(pCell)
+        *pCell = rgb;
+    else
+        _stats.pixelsOutside++;
+    _stats.pixelsWritten++;
+    _stats.pixelBytesWritten += ModelPixelBytes();
+    ModelAdvance();
+}
+
+/*********************************************************************
+* Function: static void ModelReadPixels(BYTE cmd)
+*
+* Overview: fills the read buffer with up to 0xC1 bytes of GRAM, from
+*			the window origin for 0x2E or on from the last access for
+*			0x3E, in the byte order of a memory write
+*
+********************************************************************/
+static void ModelReadPixels(BYTE cmd)
+{
+    WORD max = _reg[0xc1];
+    BYTE bytes[3];
+    BYTE n = ModelPixelBytes(), i;
+    DWORD *pCell;
+    DWORD rgb;
+
+    if(max > sizeof(_readBuf))
+        max = sizeof(_readBuf);
+    if(cmd == 0x2e)
+    {
+        _col = _colStart;
+        _page = _pageStart;
+    }
+    while(_readCount + n <= max)
+    {
+        pCell = ModelCursor();
+        rgb = (pCell)? *pCell : 0;
+        if(n == 2)
+        {
+            WORD v = (WORD)(((rgb >> 8) & 0xF800) | ((rgb >> 5) & 0x07E0) | ((rgb >> 3) & 0x001F));
+
+            bytes[0] = (BYTE)v;
+            bytes[1] = (BYTE)(v >> 8);
+        }
+        else
+        {
+        #if defined (SSD2805_PIXEL_ORDER_BGR)
+            bytes[0] = (BYTE)rgb;
+            bytes[2] = (BYTE)(rgb >> 16);
+        #else
+            bytes[0] = (BYTE)(rgb >> 16);
+            bytes[2] = (BYTE)rgb;
+        #endif
+            bytes[1] = (BYTE)(rgb >> 8);
+        }
+        for(i=0; i<n; i++)
+            _readBuf[_readCount++] = bytes[i];
+        _stats.pixelsRead++;
+        _stats.pixelBytesRead += n;
+        ModelAdvance();
+    }
+}
+
+/*********************************************************************
+* Function: static void ModelReadRequest(BYTE cmd)
+*
+* Overview: a DCS packet sent with read enable set, the panel answers
+*			memory reads with GRAM and any other read with one byte 0
+*
+********************************************************************/
+static void ModelReadRequest(BYTE cmd)
+{
+    _readCount = 0;
+    _readPos = 0;
+    if((cmd == 0x2e) || (cmd == 0x3e))
+        ModelReadPixels(cmd);
+    else if(_reg[0xc1])
+        _readBuf[_readCount++] = 0;
+    _readReady = 1;
+}
+
+/*********************************************************************
+* Function: static void ModelPanelCommand(BYTE cmd)
+*
+* Overview: executes a DCS packet once all of its parameters are in
+*
+********************************************************************/
+static void ModelPanelCommand(BYTE cmd)
+{
+    switch(cmd)
+    {
+        case 0x2a:                      // column address set
+            if(_packetBytes < 4)
+                break;
+            _colStart = ((WORD)_param[0] << 8) | _param[1];
+            _colEnd = ((WORD)_param[2] << 8) | _param[3];
+            break;
+
+        case 0x2b:                      // page address set
+            if(_packetBytes < 4)
+                break;
+            _pageStart = ((WORD)_param[0] << 8) | _param[1];
+            _pageEnd = ((WORD)_param[2] << 8) | _param[3];
+            break;
+
+        case 0x36:                      // MADCTL
+            if(_packetBytes)
+                _madctl = _param[0];
+            break;
+
+        case 0x3a:                      // pixel format
+            if(_packetBytes)
+                _pixelFormat = _param[0] & 0x07;
+            break;
+
+        default:
+            break;
+    }
+}
+
+/*********************************************************************
+* Function: static void ModelCommand(BYTE cmd)
+*
+* Overview: a command cycle, selects a local register or starts a
+*			packet of TDC bytes. 0xBF is the generic packet drop. A
+*			packet cut short by the next command is an error.
+*
+********************************************************************/
+static void ModelCommand(BYTE cmd)
+{
+    if((_mode == MODEL_MODE_PACKET) && (_packetBytes < _tdc))
+        _stats.protocolErrors++;        // SSD2805 would still wait for the rest
+
+    _cmd = cmd;
+    _regBytes = 0;
+    _readHigh = 0;
+
+    if((cmd >= 0xb0) && (cmd <= 0xd9) && (cmd != 0xbf))
+    {
+        _mode = MODEL_MODE_REG;
+        if(cmd == 0xd7)
+        {
+            _mode = MODEL_MODE_READ_DATA;
+            _readPos = 0;
+        }
+        return;
+    }
+
+    _stats.packets++;
+    _tdc = _reg[0xbc] | ((DWORD)_reg[0xbd] << 16);
+    _packetBytes = 0;
+
+    if((_reg[0xb7] & 0x0080) && (cmd != 0xbf))
+    {
+        _stats.linkPackets++;
+        _mode = MODEL_MODE_NONE;        // read request, no parameters
+        ModelReadRequest(cmd);
+        return;
+    }
+
+    // SSD2805 sends a packet each time 0xBE bytes are in
+    if(_reg[0xbe] && (_tdc > _reg[0xbe]))
+        _stats.linkPackets += (_tdc + _reg[0xbe] - 1) / _reg[0xbe];
+    else
+        _stats.linkPackets++;
+
+    _mode = MODEL_MODE_PACKET;
+    if(cmd == 0x2c)
+    {
+        _col = _colStart;
+        _page = _pageStart;
+    }
+    _pixelCount = 0;
+    if((_tdc == 0) && (cmd != 0xbf))
+        ModelPanelCommand(cmd);
+}
+
+/*********************************************************************
+* Function: static void ModelPacketByte(BYTE b)
+*
+* Overview: one data byte of a packet, dropped past TDC
+*
+********************************************************************/
+static void ModelPacketByte(BYTE b)
+{
+    if(_packetBytes >= _tdc)
+    {
+        _stats.bytesDropped++;
+        if((_cmd == 0x2c) || (_cmd == 0x3c))
+            _stats.pixelBytesDropped++;
+        return;
+    }
+    _packetBytes++;
+
+    if(_cmd == 0xbf)
+        return;                         // generic packet, nothing for GRAM
+
+    if((_cmd == 0x2c) || (_cmd == 0x3c))
+    {
+        _pixel[_pixelCount++] = b;
+        if(_pixelCount == ModelPixelBytes())
+        {
+            ModelStorePixel();
+            _pixelCount = 0;
+        }
+        return;
+    }
+
+    if(_packetBytes <= sizeof(_param))
+        _param[_packetBytes - 1] = b;
+    if(_packetBytes == _tdc)
+        ModelPanelCommand(_cmd);
+}
+
+/*********************************************************************
+* Function: static WORD ModelRegRead(BYTE reg)
+*
+* Overview: value of a local register as read back
+*
+********************************************************************/
+static WORD ModelRegRead(BYTE reg)
+{
+    switch(reg)
+    {
+        case 0xc6:
+            return (MODEL_ISR_PLS | ((_readReady)? MODEL_ISR_RDR : 0));
+        case 0xc2:
+            return ((_readReady)? _readCount : 0);
+        default:
+            return (_reg[reg]);
+    }
+}
+
+/*********************************************************************
+* Function: static BYTE ModelReadByte(void)
+*
+* Overview: next byte of the read buffer, read data ready is cleared
+*			with the last one
+*
+********************************************************************/
+static BYTE ModelReadByte(void)
+{
+    BYTE b = 0;
+
+    if(_readReady && (_readPos < _readCount))
+        b = _readBuf[_readPos++];
+    if(_readPos >= _readCount)
+        _readReady = 0;
+    return (b);
+}
+
+void SSD2805ModelReset(void)
+{
+    memset(_reg, 0, sizeof(_reg));
+    _reg[0xb0] = 0x2805;                // device identification
+    _mode = MODEL_MODE_NONE;
+    _regBytes = 0;
+    _readHigh = 0;
+    _readCount = 0;
+    _readPos = 0;
+    _readReady = 0;
+    _tdc = 0;
+    _packetBytes = 0;
+
+    _colStart = 0;
+    _colEnd = SSD2805_MODEL_WIDTH - 1;
+    _pageStart = 0;
+    _pageEnd = SSD2805_MODEL_HEIGHT - 1;
+    _col = 0;
+    _page = 0;
+    _madctl = 0;
+    _pixelFormat = 0x06;
+    _pixelCount = 0;
+}
+
+void SSD2805ModelSelect(BYTE select)
+{
+    _selected = select;
+}
+
+void SSD2805ModelSetDC(BYTE data)
+{
+    _dc = data;
+}
+
+void SSD2805ModelWrite(WORD value)
+{
+    _ticks += SSD2805_MODEL_TICKS_PER_CYCLE;
+    _stats.bytesWritten += MODEL_BUS_BYTES;
+
+    if(!_selected)
+    {
+        _stats.protocolErrors++;
+        return;
+    }
+    if(!_dc)
+    {
+        ModelCommand((BYTE)value);
+        return;
+    }
+
+    switch(_mode)
+    {
+        case MODEL_MODE_REG:
+        #if defined (USE_16BIT_PMP)
+            _reg[_cmd] = value;
+        #else
+            if(_regBytes == 0)
+                _regValue = (BYTE)value;                // lower byte first
+            else if(_regBytes == 1)
+                _reg[_cmd] = _regValue | ((WORD)(BYTE)value << 8);
+            else
+                _stats.protocolErrors++;
+            _regBytes++;
+        #endif
+            break;
+
+        case MODEL_MODE_PACKET:
+            ModelPacketByte((BYTE)value);
+        #if defined (USE_16BIT_PMP)
+            ModelPacketByte((BYTE)(value >> 8));
+        #endif
+            break;
+
+        default:
+            _stats.protocolErrors++;
+            break;
+    }
+}
+
+WORD SSD2805ModelRead(void)
+{
+    WORD value;
+
+    _ticks += SSD2805_MODEL_TICKS_PER_CYCLE;
+    _stats.bytesRead += MODEL_BUS_BYTES;
+
+    if(!_selected || !_dc)
+    {
+        _stats.protocolErrors++;
+        return (0xFFFF);
+    }
+
+    switch(_mode)
+    {
+        case MODEL_MODE_REG:
+            value = ModelRegRead(_cmd);
+        #if !defined (USE_16BIT_PMP)
+            value = (_readHigh)? (value >> 8) : (value & 0x00FF);
+            _readHigh ^= 1;
+        #endif
+            return (value);
+
+        case MODEL_MODE_READ_DATA:
+            value = ModelReadByte();
+        #if defined (USE_16BIT_PMP)
+            value |= (WORD)ModelReadByte() << 8;    // lower byte first
+        #endif
+            return (value);
+
+        default:
+            _stats.protocolErrors++;
+            return (0xFFFF);
+    }
+}
+
+unsigned int SSD2805ModelTicks(void)
+{
+    _ticks += SSD2805_MODEL_TICKS_PER_READ;
+    return (_ticks);
+}
+
+void SSD2805ModelFill(DWORD rgb)
+{
+    WORD x, y;
+
+    for(y=0; y<SSD2805_MODEL_HEIGHT; y++)
+        for(x=0; x<SSD2805_MODEL_WIDTH; x++)
+            _gram[y][x] = rgb;
+}
+
+DWORD SSD2805ModelPixel(WORD x, WORD y)
+{
+    return (_gram[y][x]);
+}
+
+WORD SSD2805ModelReg(BYTE reg)
+{
+    return (_reg[reg]);
+}
+
+void SSD2805ModelGetStats(SSD2805_MODEL_STATS *pStats)
+{
+    *pStats = _stats;
+}
+
+void SSD2805ModelClearStats(void)
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
@@ -0,0 +1,158 @@
+/*********************************************************************
+ *
+ *	SSD2805 and LH154Q01 bus model for the host build
+ *
+ *********************************************************************
+ * FileName:        SSD2805Model.h
+ * Processor:       host PC
+ * Compiler:        gcc
+ * Company:         TechToys Company
+ *
+ * Software License Agreement
+ *
+ * You should refer to the license agreement accompanying this
+ * Software for additional information regarding your rights and
+ * obligations.
+ *
+ ********************************************************************/
+/*
+*********************************************************************
+* Remarks: the model sits on the 8080 bus in place of the PMP. It
+* decodes what the driver writes the way SSD2805 does: a command cycle
+* selects a local register (0xB0-0xD9) or starts a DCS packet to the
+* panel, data cycles carry the register value or the TDC bytes of the
+* packet set in 0xBC/0xBD. Bytes past TDC are dropped, as SSD2805
+* does with the padding of 16-bit cycles. The panel side keeps GRAM
+* for 0x2A/0x2B windows, 0x2C/0x3C memory writes, 0x36 MADCTL and
+* 0x3A pixel format, and answers 0x2E/0x3E memory reads when read
+* enable (0xB7 bit 7) is set. 0xC6 reports the PLL locked at once.
+*
+* Data cycles with no command before them or with chip select high,
+* and packets cut short by the next command, are protocol errors and
+* counted.
+*********************************************************************
+*/
+#ifndef _SSD2805MODEL_H
+#define _SSD2805MODEL_H
+
+#include "GenericTypeDefs.h"
+
+#define SSD2805_MODEL_WIDTH         240
+#define SSD2805_MODEL_HEIGHT        240
+
+// core timer ticks per ReadCoreTimer() call and per bus cycle
+#define SSD2805_MODEL_TICKS_PER_READ    20
+#define SSD2805_MODEL_TICKS_PER_CYCLE   2
+
+/*********************************************************************
+* Overview: Bus traffic and errors seen by the model
+*
+*********************************************************************/
+typedef struct
+{
+    DWORD   bytesWritten;       // bytes written, 2 per cycle on a 16-bit bus
+    DWORD   bytesRead;
+    DWORD   bytesDropped;       // data bytes past TDC, the padding of 16-bit cycles
+    DWORD   pixelBytesDropped;  // of them in memory writes, where TDC counts the padding
+    DWORD   pixelsWritten;      // pixels of memory writes
+    DWORD   pixelBytesWritten;  // and their bytes, the rest of bytesWritten is overhead
+    DWORD   pixelsRead;         // pixels returned by memory reads
+    DWORD   pixelBytesRead;
+    DWORD   packets;            // DCS packets to the panel
+    DWORD   linkPackets;        // MIPI packets, DCS packets split at the 0xBE size
+    DWORD   pixelsOutside;      // memory writes outside the panel
+    DWORD   protocolErrors;     // see the remarks above
+} SSD2805_MODEL_STATS;
+
+/*********************************************************************
+* Function: void SSD2805ModelReset(void)
+*
+* Overview: power-on state of SSD2805 and the panel, GRAM and the
+*			statistics are kept
+*
+********************************************************************/
+void SSD2805ModelReset(void);
+
+/*********************************************************************
+* Function: void SSD2805ModelSelect(BYTE select)
+*
+* Overview: chip select, 1 for CSX# low
+*
+********************************************************************/
+void SSD2805ModelSelect(BYTE select);
+
+/*********************************************************************
+* Function: void SSD2805ModelSetDC(BYTE data)
+*
+* Overview: SDC line, 0 for a command cycle, 1 for data
+*
+********************************************************************/
+void SSD2805ModelSetDC(BYTE data);
+
+/*********************************************************************
+* Function: void SSD2805ModelWrite(WORD value)
+*
+* Overview: one write cycle, 8 or 16 bits wide depending on
+*			USE_16BIT_PMP, the low byte goes first on the MIPI link
+*
+********************************************************************/
+void SSD2805ModelWrite(WORD value);
+
+/*********************************************************************
+* Function: WORD SSD2805ModelRead(void)
+*
+* Overview: one read cycle
+*
+********************************************************************/
+WORD SSD2805ModelRead(void);
+
+/*********************************************************************
+* Function: unsigned int SSD2805ModelTicks(void)
+*
+* Overview: the core timer, advances SSD2805_MODEL_TICKS_PER_READ per
+*			call and SSD2805_MODEL_TICKS_PER_CYCLE per bus cycle
+*
+********************************************************************/
+unsigned int SSD2805ModelTicks(void);
+
+/*********************************************************************
+* Function: void SSD2805ModelFill(DWORD rgb)
+*
+* Overview: sets all of GRAM to 0x00RRGGBB without bus traffic
+*
+********************************************************************/
+void SSD2805ModelFill(DWORD rgb);
+
+/*********************************************************************
+* Function: DWORD SSD2805ModelPixel(WORD x, WORD y)
+*
+* Overview: returns the panel pixel at (x, y) as 0x00RRGGBB
+*
+********************************************************************/
+DWORD SSD2805ModelPixel(WORD x, WORD y);
+
+/*********************************************************************
+* Function: WORD SSD2805ModelReg(BYTE reg)
+*
+* Overview: returns a local register of the model
+*
+********************************************************************/
+WORD SSD2805ModelReg(BYTE reg);
+
+/*********************************************************************
+* Function: void SSD2805ModelGetStats(SSD2805_MODEL_STATS *pStats)
+*
+* Overview: copies the statistics
+*
+********************************************************************/
+void SSD2805ModelGetStats(SSD2805_MODEL_STATS *pStats);
+
+/*********************************************************************
+* Function: void SSD2805ModelClearStats(void)
+*
+* Overview: clears the statistics
+*
+********************************************************************/
+void SSD2805ModelClearStats(void);
+
+#endif // _SSD2805MODEL_H
@@ -0,0 +1,887 @@
+/*********************************************************************
+ *
+ *	Golden image tests of the SSD2805 driver on the host
+ *
+ *********************************************************************
+ * FileName:        TestMain.c
+ * Processor:       host PC
+ * Compiler:        gcc
+ * Company:         TechToys Company
+ *
+ * Software License Agreement
+ *
+ * You should refer to the license agreement accompanying this
+ * Software for additional information regarding your rights and
+ * obligations.
+ *
+ ********************************************************************/
+/*
+*********************************************************************
+* Remarks: each scene draws with the driver API into the GRAM of the
+* bus model (SSD2805Model.c), which starts black and is filled without
+* bus traffic. The panel image is compared with the reference image
+* Reference/<COLOR_DEPTH>/<scene>.ppm of the color depth of the build.
+* The pixels written and read are the same in every build and checked
+* exactly. Everything else on the bus (commands, windows, TDC, register
+* polls and the padding of 16-bit cycles) is overhead and has to stay
+* within the budget of the scene in _scenes[], which holds for both bus
+* widths and color depths.
+*
+* Usage: SSD2805Test      runs all scenes, exit code 1 on a failure
+*        SSD2805Test -u   writes the reference images and prints the
+*                         pixel counts and the overhead of this build
+*
+* On an image mismatch the panel image is written to <scene>.out.ppm.
+* The tree has no Primitive.c, text is drawn with a 5x7 font local to
+* this file. The pixel scene also reads pixels back with GetPixel().
+* Clipping is the edge handling of the driver itself, the clip scene
+* moves a sprite across the edges and reads its background from GRAM,
+* the sprite scene gets it from a callback instead. The gradient scene
+* has each direction plain and dithered, the orient scene draws and
+* reads back in each MADCTL rotation and mirror, and the rgb666 and
+* rgb888 scenes switch to the 3-byte pixel formats.
+* Before the scenes SSD2805ConvertRow888() is checked against a per
+* pixel reference, see TestConvertRow888(), and the timing model of
+* SSD2805Timing.c against the bus traffic of the model, see
+* TestTiming().
+*********************************************************************
+*/
+#include <stdio.h>
+#include <string.h>
+#include "HardwareProfile.h"
+#include "Graphics/DisplayDriver.h"
+#include "Graphics/SSD2805.h"
+#include "Graphics/SSD2805Timing.h"
+#include "SSD2805Model.h"
+
+// colors differ with COLOR_DEPTH, each has its own reference images
+#if (COLOR_DEPTH == 24)
+#define REFERENCE_DIR       "Reference/24/"
+#else
+#define REFERENCE_DIR       "Reference/16/"
+#endif
+
+typedef struct
+{
+    const char  *name;
+    BYTE        (*draw)(void);      // returns 0 if a read back check failed
+    DWORD       pixelsWritten;      // pixels of memory writes, the same in every build
+    DWORD       pixelsRead;
+    DWORD       overheadWritten;    // budget of bus bytes besides the pixel data
+    DWORD       overheadRead;
+} TEST_SCENE;
+
+/*********************************************************************
+* 5x7 font, row bitmaps with bit 4 the leftmost column
+*********************************************************************/
+typedef struct
+{
+    char    c;
+    BYTE    rows[7];
+} TEST_GLYPH;
+
+static const TEST_GLYPH _font[] =
+{
+    {' ', {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    {'0', {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E}},
+    {'2', {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F}},
+    {'5', {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E}},
+    {'8', {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E}},
+    {'D', {0x1E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x1E}},
+    {'E', {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}},
+    {'H', {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}},
+    {'O', {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}},
+    {'S', {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E}},
+    {'T', {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}},
+};
+
+#define GLYPH_WIDTH         6       // 5 columns and a space
+#define GLYPH_HEIGHT        8       // 7 rows and a space
+#define TEXT_SCALE          2
+
+/*********************************************************************
+* Function: static const BYTE *TestGlyph(char c)
+*
+* Overview: rows of character 'c', a blank for characters not in _font
+*
+********************************************************************/
+static const BYTE *TestGlyph(char c)
+{
+    WORD i;
+
+    for(i=0; i<sizeof(_font)/sizeof(_font[0]); i++)
+    {
+        if(_font[i].c == c)
+            return (_font[i].rows);
+    }
+    return (_font[0].rows);
+}
+
+/*********************************************************************
+* Function: static BYTE TestGlyphPixel(const BYTE *pRows, WORD x, WORD y)
+*
+* Overview: 1 if pixel (x, y) of a glyph cell is set
+*
+********************************************************************/
+static BYTE TestGlyphPixel(const BYTE *pRows, WORD x, WORD y)
+{
+    if((x >= 5) || (y >= 7))
+        return (0);
+    return ((pRows[y] >> (4 - x)) & 1);
+}
+
+/*********************************************************************
+* Function: static BYTE TestSameColor(GFX_COLOR a, GFX_COLOR b, BYTE format)
+*
+* Overview: 1 if the colors are the same in the panel pixel format
+*
+********************************************************************/
+static BYTE TestSameColor(GFX_COLOR a, GFX_COLOR b, BYTE format)
+{
+#if (COLOR_DEPTH == 24)
+    if(format == SSD2805_PIXEL_FORMAT_16)
+        return ((a & 0xF8FCF8) == (b & 0xF8FCF8));
+    if(format == SSD2805_PIXEL_FORMAT_18)
+        return ((a & 0xFCFCFC) == (b & 0xFCFCFC));
+#else
+    (void)format;                       // RGB565 colors survive every format
+#endif
+    return (a == b);
+}
+
+/*********************************************************************
+* Scenes
+*********************************************************************/
+static BYTE SceneClear(void)
+{
+    SetColor(RGBConvert(0x20, 0x40, 0x80));
+    ClearDevice();
+    return (1);
+}
+
+static BYTE ScenePixel(void)
+{
+    static const SHORT corner[4][2] = {{0, 0}, {239, 0}, {0, 239}, {239, 239}};
+    GFX_COLOR color;
+    BYTE ok = 1;
+    SHORT i;
+
+    SetColor(RGBConvert(0xFF, 0xFF, 0xFF));
+    for(i=0; i<4; i++)
+        PutPixel(corner[i][0], corner[i][1]);
+
+    for(i=4; i<236; i+=4)
+    {
+        color = RGBConvert(i, 0xFF - i, 0x80);
+        SetColor(color);
+        PutPixel(i, i);
+        PutPixel(239 - i, i);
+    }
+
+    // read back through DCS 0x2E, one pixel each
+    for(i=0; i<4; i++)
+    {
+        if(GetPixel(corner[i][0], corner[i][1]) != RGBConvert(0xFF, 0xFF, 0xFF))
+            ok = 0;
+    }
+    if(GetPixel(120, 120) != RGBConvert(120, 0xFF - 120, 0x80))
+        ok = 0;
+    if(GetPixel(121, 120) != 0)
+        ok = 0;
+    return (ok);
+}
+
+static BYTE SceneFill(void)
+{
+    SetColor(RGBConvert(0xFF, 0x00, 0x00));
+    SSD2805QueueBurst(10, 10, 109, 59, NULL);
+    SetColor(RGBConvert(0x00, 0xFF, 0x00));
+    SSD2805QueueBurst(130, 10, 229, 59, NULL);
+    SetColor(RGBConvert(0x00, 0x00, 0xFF));
+    SSD2805QueueBurst(10, 70, 229, 79, NULL);
+    SSD2805PresentFrame();
+
+    SSD2805FillGradient(10, 90, 229, 149, RGBConvert(0x00, 0x00, 0x00), RGBConvert(0xFF, 0xFF, 0xFF), SSD2805_GRADIENT_HORIZONTAL, 0);
+    SSD2805FillGradient(10, 160, 229, 229, RGBConvert(0xFF, 0x00, 0x00), RGBConvert(0x00, 0x00, 0xFF), SSD2805_GRADIENT_VERTICAL, 1);
+    return (1);
+}
+
+static BYTE SceneImage(void)
+{
+    static GFX_COLOR image[24][32];
+    static BYTE raw[16*16*3];
+    BYTE format = SSD2805GetPixelFormat();
+    BYTE size = (format == SSD2805_PIXEL_FORMAT_16)? 2 : 3;
+    BYTE *p = raw;
+    DWORD bytes, n;
+    WORD x, y, v;
+
+    for(y=0; y<24; y++)
+        for(x=0; x<32; x++)
+            image[y][x] = RGBConvert(x*8, y*10, (x + y)*4);
+    SSD2805QueueBurst(20, 20, 51, 43, &image[0][0]);
+    SSD2805QueueBurst(180, 200, 211, 223, &image[0][0]);
+    SSD2805PresentFrame();
+
+    // panel byte order, RGB565 lower byte first, 18/24-bit R, G, B
+    for(y=0; y<16; y++)
+    {
+        for(x=0; x<16; x++)
+        {
+            // 0xFF, 0xC0, 0x00 and 0x00, 0x40, 0xC0
+            if(size == 2)
+            {
+                v = ((x ^ y) & 4)? 0xFE00 : 0x0218;
+                *p++ = (BYTE)v;
+                *p++ = (BYTE)(v >> 8);
+            }
+            else
+            {
+            #if defined (SSD2805_PIXEL_ORDER_BGR)
+                *p++ = ((x ^ y) & 4)? 0x00 : 0xC0;
+                *p++ = ((x ^ y) & 4)? 0xC0 : 0x40;
+                *p++ = ((x ^ y) & 4)? 0xFF : 0x00;
+            #else
+                *p++ = ((x ^ y) & 4)? 0xFF : 0x00;
+                *p++ = ((x ^ y) & 4)? 0xC0 : 0x40;
+                *p++ = ((x ^ y) & 4)? 0x00 : 0xC0;
+            #endif
+            }
+        }
+    }
+    SSD2805PushRaw(100, 100, 115, 115, raw);
+
+    // the same in odd sized pieces, a 16-bit bus pairs bytes across them
+    bytes = SSD2805RawBegin(130, 100, 145, 115);
+    for(x=0; x<bytes; x+=n)
+    {
+        n = (bytes - x > 7)? 7 : bytes - x;
+        SSD2805RawWrite(&raw[x], n);
+    }
+    return (bytes == 16*16*size);
+}
+
+static BYTE SceneText(void)
+{
+    static const char opaque[] = "SSD2805";
+    static const char transparent[] = "HOST TEST";
+    static GFX_COLOR cell[GLYPH_HEIGHT*TEXT_SCALE][(sizeof(opaque) - 1)*GLYPH_WIDTH*TEXT_SCALE];
+    WORD width = sizeof(cell[0])/sizeof(cell[0][0]);
+    const BYTE *pRows;
+    WORD i, x, y;
+
+    // opaque text, glyph cells rendered to a buffer and sent as one burst
+    for(y=0; y<GLYPH_HEIGHT*TEXT_SCALE; y++)
+    {
+        for(x=0; x<width; x++)
+        {
+            pRows = TestGlyph(opaque[x/(GLYPH_WIDTH*TEXT_SCALE)]);
+            cell[y][x] = TestGlyphPixel(pRows, (x % (GLYPH_WIDTH*TEXT_SCALE))/TEXT_SCALE, y/TEXT_SCALE)?
+                            RGBConvert(0xFF, 0xFF, 0x00) : RGBConvert(0x00, 0x00, 0x60);
+        }
+    }
+    SSD2805QueueBurst(20, 30, 20 + width - 1, 30 + GLYPH_HEIGHT*TEXT_SCALE - 1, &cell[0][0]);
+    SSD2805PresentFrame();
+
+    // transparent text over a gradient, set pixels only
+    SSD2805FillGradient(0, 100, 239, 139, RGBConvert(0x00, 0x80, 0x00), RGBConvert(0x00, 0x00, 0x80), SSD2805_GRADIENT_DIAGONAL, 0);
+    SetColor(RGBConvert(0xFF, 0xFF, 0xFF));
+    for(i=0; i<sizeof(transparent) - 1; i++)
+    {
+        pRows = TestGlyph(transparent[i]);
+        for(y=0; y<7*TEXT_SCALE; y++)
+        {
+            for(x=0; x<5*TEXT_SCALE; x++)
+            {
+                if(TestGlyphPixel(pRows, x/TEXT_SCALE, y/TEXT_SCALE))
+                    PutPixel(12 + i*GLYPH_WIDTH*TEXT_SCALE + x, 112 + y);
+            }
+        }
+    }
+    return (1);
+}
+
+static BYTE SceneClip(void)
+{
+    static GFX_COLOR image[16][16];
+    static GFX_COLOR buffer[2*16*16];
+    SSD2805_SPRITE sprite;
+    GFX_COLOR key = RGBConvert(0xFF, 0x00, 0xFF);
+    WORD x, y;
+
+    SSD2805FillGradient(0, 0, 239, 239, RGBConvert(0x40, 0x00, 0x00), RGBConvert(0x00, 0x40, 0xFF), SSD2805_GRADIENT_DIAGONAL, 0);
+
+    // last row and column of the panel
+    SetColor(RGBConvert(0xFF, 0xFF, 0x00));
+    SSD2805QueueBurst(0, 239, 239, 239, NULL);
+    SSD2805QueueBurst(239, 0, 239, 238, NULL);
+    SSD2805PresentFrame();
+
+    // ring with a transparent inside and corners
+    for(y=0; y<16; y++)
+    {
+        for(x=0; x<16; x++)
+        {
+            SHORT dx = 2*x - 15, dy = 2*y - 15;
+            WORD d = dx*dx + dy*dy;
+
+            image[y][x] = ((d >= 100) && (d <= 225))? RGBConvert(0xFF, 0xFF, 0xFF) : key;
+        }
+    }
+
+    // background read back from GRAM, moves clamped at the edges
+    SSD2805SpriteInit(&sprite, &image[0][0], 16, 16, buffer, NULL);
+    sprite.useKey = 1;
+    sprite.keyColor = key;
+    SSD2805SpriteMove(&sprite, 100, 100);
+    SSD2805SpriteMove(&sprite, 106, 104);
+    SSD2805SpriteMove(&sprite, -8, -8);
+    SSD2805SpriteMove(&sprite, 250, 250);
+    SSD2805SpriteHide(&sprite);
+    SSD2805SpriteMove(&sprite, 230, -3);
+    return (1);
+}
+
+static BYTE SceneGradient(void)
+{
+    // plain on the left, dithered on the right
+    SSD2805FillGradient(0, 0, 119, 59, RGBConvert(0x00, 0x00, 0x00), RGBConvert(0xFF, 0xFF, 0xFF), SSD2805_GRADIENT_HORIZONTAL, 0);
+    SSD2805FillGradient(120, 0, 239, 59, RGBConvert(0x00, 0x00, 0x00), RGBConvert(0xFF, 0xFF, 0xFF), SSD2805_GRADIENT_HORIZONTAL, 1);
+    SSD2805FillGradient(0, 60, 119, 179, RGBConvert(0x00, 0x20, 0x00), RGBConvert(0x00, 0x60, 0x40), SSD2805_GRADIENT_VERTICAL, 0);
+    SSD2805FillGradient(120, 60, 239, 179, RGBConvert(0x00, 0x20, 0x00), RGBConvert(0x00, 0x60, 0x40), SSD2805_GRADIENT_VERTICAL, 1);
+    SSD2805FillGradient(0, 180, 119, 239, RGBConvert(0xFF, 0x80, 0x00), RGBConvert(0x20, 0x00, 0x80), SSD2805_GRADIENT_DIAGONAL, 0);
+    SSD2805FillGradient(120, 180, 239, 239, RGBConvert(0xFF, 0x80, 0x00), RGBConvert(0x20, 0x00, 0x80), SSD2805_GRADIENT_DIAGONAL, 1);
+
+    // odd position and size, the dither phase follows the screen position
+    SSD2805FillGradient(37, 101, 82, 140, RGBConvert(0x00, 0x00, 0x40), RGBConvert(0x40, 0x00, 0x00), SSD2805_GRADIENT_DIAGONAL, 1);
+    return (1);
+}
+
+/*********************************************************************
+* Function: static BYTE SceneOrientation(void)
+*
+* Overview: draws an L shaped mark and reads it back in each rotation
+*			and mirror of SSD2805SetOrientation(). The panel maps the
+*			window through MADCTL, so each mark lands in another
+*			place in GRAM. DISP_ORIENTATION is set again at the end.
+*
+********************************************************************/
+static BYTE SceneOrientation(void)
+{
+    static const WORD degrees[6] = {0, 90, 180, 270, 0, 0};
+    static const BYTE mirror[6] = {SSD2805_MIRROR_NONE, SSD2805_MIRROR_NONE, SSD2805_MIRROR_NONE,
+                                   SSD2805_MIRROR_NONE, SSD2805_MIRROR_X, SSD2805_MIRROR_Y};
+    GFX_COLOR color;
+    BYTE ok = 1;
+    SHORT i, x, y;
+
+    for(i=0; i<6; i++)
+    {
+        if(!SSD2805SetOrientation(degrees[i], mirror[i]))
+            ok = 0;
+        color = RGBConvert((i & 1)? 0xFF : 0x40, (i & 2)? 0xFF : 0x40, (i & 4)? 0xFF : 0x40);
+        x = 10 + 8*i;
+        y = 10 + 24*i;
+        SetColor(color);
+        SSD2805QueueBurst(x, y, x + 39, y + 5, NULL);
+        SSD2805QueueBurst(x, y + 6, x + 5, y + 19, NULL);
+        SSD2805PresentFrame();
+        if((GetPixel(x + 39, y) != color) || (GetPixel(x, y + 19) != color) || (GetPixel(x + 6, y + 6) != 0))
+            ok = 0;
+    }
+
+    if(!SSD2805SetOrientation(DISP_ORIENTATION, SSD2805_MIRROR_NONE) || (SSD2805GetOrientation() != DISP_ORIENTATION))
+        ok = 0;
+    return (ok);
+}
+
+/*********************************************************************
+* Function: static void TestBackground(SHORT left, SHORT top, SHORT right,
+*						SHORT bottom, GFX_COLOR *pDst, WORD stride)
+*
+* Overview: the background of the sprite scene, an SSD2805_BACKGROUND_FUNC
+*
+********************************************************************/
+static void TestBackground(SHORT left, SHORT top, SHORT right, SHORT bottom, GFX_COLOR *pDst, WORD stride)
+{
+    SHORT x, y;
+
+    for(y=top; y<=bottom; y++)
+        for(x=left; x<=right; x++)
+            pDst[(y - top)*stride + (x - left)] = RGBConvert(x, y, ((x ^ y) & 8)? 0xC0 : 0x40);
+}
+
+/*********************************************************************
+* Function: static BYTE SceneSprite(void)
+*
+* Overview: moves a sprite over a background it gets from
+*			TestBackground() instead of GRAM, so nothing is read back.
+*			The moves overlap, jump and leave the drawn background.
+*
+********************************************************************/
+static BYTE SceneSprite(void)
+{
+    static GFX_COLOR row[120];
+    static GFX_COLOR image[16][16];
+    static GFX_COLOR buffer[2*16*16];
+    SSD2805_SPRITE sprite;
+    GFX_COLOR key = RGBConvert(0xFF, 0x00, 0xFF);
+    WORD x, y;
+
+    // the background of the region the sprite moves in
+    for(y=60; y<180; y++)
+    {
+        TestBackground(60, y, 179, y, row, 120);
+        SSD2805QueueBurst(60, y, 179, y, row);
+        SSD2805PresentFrame();
+    }
+
+    // arrow pointing up left, transparent around it
+    for(y=0; y<16; y++)
+        for(x=0; x<16; x++)
+            image[y][x] = ((x <= y) && (x + y >= 2*(y/2)) && (y - x < 6 || x < 3))? RGBConvert(0xFF, 0xFF, 0xFF) : key;
+
+    SSD2805SpriteInit(&sprite, &image[0][0], 16, 16, buffer, TestBackground);
+    sprite.useKey = 1;
+    sprite.keyColor = key;
+    SSD2805SpriteMove(&sprite, 70, 70);
+    SSD2805SpriteMove(&sprite, 74, 72);
+    SSD2805SpriteMove(&sprite, 120, 90);
+    SSD2805SpriteMove(&sprite, 121, 90);
+    SSD2805SpriteMove(&sprite, 170, 170);
+    SSD2805SpriteHide(&sprite);
+    SSD2805SpriteMove(&sprite, 100, 140);
+    return (1);
+}
+
+/*********************************************************************
+* Function: static BYTE TestPixelFormat(BYTE format)
+*
+* Overview: draws in a 3-byte pixel format: clear, a dithered gradient,
+*			bursts and raw pixels of an odd pixel count, which end in a
+*			padded cycle on a 16-bit bus, and read back. The pixel
+*			format of ResetDevice() is set again at the end.
+*
+********************************************************************/
+static BYTE TestPixelFormat(BYTE format)
+{
+    static GFX_COLOR image[9][15];
+    static BYTE raw[9*15*3];
+    BYTE mask = (format == SSD2805_PIXEL_FORMAT_18)? 0xFC : 0xFF;
+    BYTE ok = 1, r, g, b;
+    WORD x, y;
+    BYTE *p = raw;
+
+    if(!SSD2805SetPixelFormat(format))
+        return (0);
+
+    SetColor(RGBConvert(0x10, 0x20, 0x30));
+    ClearDevice();
+    SSD2805FillGradient(10, 10, 229, 69, RGBConvert(0xFF, 0x00, 0x00), RGBConvert(0x00, 0x00, 0xFF), SSD2805_GRADIENT_HORIZONTAL, 1);
+
+    for(y=0; y<9; y++)
+    {
+        for(x=0; x<15; x++)
+        {
+            r = x*17;
+            g = y*28;
+            b = 0x80;
+            image[y][x] = RGBConvert(r, g, b);
+        #if defined (SSD2805_PIXEL_ORDER_BGR)
+            *p++ = b & mask;
+            *p++ = g & mask;
+            *p++ = r & mask;
+        #else
+            *p++ = r & mask;                // as a DCS memory write, R first
+            *p++ = g & mask;
+            *p++ = b & mask;
+        #endif
+        }
+    }
+    SSD2805QueueBurst(10, 80, 24, 88, &image[0][0]);
+    SetColor(RGBConvert(0x00, 0xFF, 0x80));
+    SSD2805QueueBurst(30, 80, 44, 88, NULL);
+    SSD2805PresentFrame();
+    SSD2805PushRaw(50, 80, 64, 88, raw);
+    PutPixel(70, 80);
+
+    // read back at the precision of the format
+    if(!TestSameColor(GetPixel(10, 80), image[0][0], format) || !TestSameColor(GetPixel(24, 88), image[8][14], format))
+        ok = 0;
+    if(!TestSameColor(GetPixel(64, 88), image[8][14], format) || !TestSameColor(GetPixel(70, 80), RGBConvert(0x00, 0xFF, 0x80), format))
+        ok = 0;
+
+    SSD2805SetPixelFormat(SSD2805_PIXEL_FORMAT);
+    return (ok);
+}
+
+static BYTE SceneRgb666(void)
+{
+    return (TestPixelFormat(SSD2805_PIXEL_FORMAT_18));
+}
+
+static BYTE SceneRgb888(void)
+{
+    return (TestPixelFormat(SSD2805_PIXEL_FORMAT_24));
+}
+
+// PutPixel() and a burst cost up to 24 bytes of window and packet setup,
+// GetPixel() up to 48 bytes written and 8 read besides the pixel. The
+// budgets hold for every build of the Makefile.
+static const TEST_SCENE _scenes[] =
+{
+    // name      draw            pixels written, read    overhead written, read
+    {"clear",   SceneClear,     57600, 0,               32, 0},
+    {"pixel",   ScenePixel,     120, 6,                 120*24 + 6*48, 6*8},
+    {"fill",    SceneFill,      40800, 0,               128, 0},
+    {"image",   SceneImage,     2048, 0,                96, 0},
+    {"text",    SceneText,      11400, 0,               456*24 + 64, 0},
+    {"clip",    SceneClip,      60263, 1160,            2304, 512},
+    {"gradient",SceneGradient,  59440, 0,               7*24 + 32, 0},
+    {"orient",  SceneOrientation, 1944, 18,             6*192, 18*8},
+    {"sprite",  SceneSprite,    16808, 0,               120*24 + 512, 0},
+    {"rgb666",  SceneRgb666,    71206, 4,               384, 4*8},
+    {"rgb888",  SceneRgb888,    71206, 4,               384, 4*8},
+};
+
+/*********************************************************************
+* Function: static BYTE TestWriteImage(const char *pPath)
+*
+* Overview: writes the panel image as a binary PPM
+*
+* Output: 1 if written
+*
+********************************************************************/
+static BYTE TestWriteImage(const char *pPath)
+{
+    FILE *fp = fopen(pPath, "wb");
+    DWORD rgb;
+    WORD x, y;
+
+    if(fp == NULL)
+        return (0);
+    fprintf(fp, "P6\n%d %d\n255\n", SSD2805_MODEL_WIDTH, SSD2805_MODEL_HEIGHT);
+    for(y=0; y<SSD2805_MODEL_HEIGHT; y++)
+    {
+        for(x=0; x<SSD2805_MODEL_WIDTH; x++)
+        {
+            rgb = SSD2805ModelPixel(x, y);
+            fputc((int)(rgb >> 16) & 0xFF, fp);
+            fputc((int)(rgb >> 8) & 0xFF, fp);
+            fputc((int)rgb & 0xFF, fp);
+        }
+    }
+    fclose(fp);
+    return (1);
+}
+
+/*********************************************************************
+* Function: static DWORD TestCompareImage(const char *pPath)
+*
+* Overview: compares the panel image with a binary PPM
+*
+* Output: number of pixels that differ, all of them if the file cannot
+*		  be read
+*
+********************************************************************/
+static DWORD TestCompareImage(const char *pPath)
+{
+    FILE *fp = fopen(pPath, "rb");
+    DWORD rgb, diff = 0;
+    int width, height, maxval, r, g, b;
+    WORD x, y;
+
+    if(fp == NULL)
+        return ((DWORD)SSD2805_MODEL_WIDTH*SSD2805_MODEL_HEIGHT);
+    if((fscanf(fp, "P6 %d %d %d", &width, &height, &maxval) != 3) || (fgetc(fp) == EOF) ||
+        (width != SSD2805_MODEL_WIDTH) || (height != SSD2805_MODEL_HEIGHT) || (maxval != 255))
+    {
+        fclose(fp);
+        return ((DWORD)SSD2805_MODEL_WIDTH*SSD2805_MODEL_HEIGHT);
+    }
+    for(y=0; y<SSD2805_MODEL_HEIGHT; y++)
+    {
+        for(x=0; x<SSD2805_MODEL_WIDTH; x++)
+        {
+            r = fgetc(fp);
+            g = fgetc(fp);
+            b = fgetc(fp);
+            if(b == EOF)
+                diff++;
+            rgb = SSD2805ModelPixel(x, y);
+            if(((DWORD)r != ((rgb >> 16) & 0xFF)) || ((DWORD)g != ((rgb >> 8) & 0xFF)) || ((DWORD)b != (rgb & 0xFF)))
+                diff++;
+        }
+    }
+    fclose(fp);
+    return (diff);
+}
+
+// row length of the conversion check, two 16 pixel SSE2 runs and a tail
+#define CONVERT_PIXELS      40
+#define CONVERT_GUARD       0x5A5A
+
+/*********************************************************************
+* Function: static WORD TestConvert565(const BYTE *pRgb, SHORT x, SHORT y, BYTE dither)
+*
+* Overview: reference of SSD2805ConvertRow888() for one pixel, the
+*			Bayer threshold added to each channel with saturation and
+*			the low bits dropped
+*
+********************************************************************/
+static WORD TestConvert565(const BYTE *pRgb, SHORT x, SHORT y, BYTE dither)
+{
+    static const BYTE bayer[4][4] = {{0, 8, 2, 10}, {12, 4, 14, 6}, {3, 11, 1, 9}, {15, 7, 13, 5}};
+    WORD t = (dither)? bayer[y & 3][x & 3] : 0;
+    WORD r = pRgb[0] + (t >> 1), g = pRgb[1] + (t >> 2), b = pRgb[2] + (t >> 1);
+
+    r = (r > 255)? 255 : r;
+    g = (g > 255)? 255 : g;
+    b = (b > 255)? 255 : b;
+    return (((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+}
+
+/*********************************************************************
+* Function: static WORD TestConvertRow888(void)
+*
+* Overview: checks SSD2805ConvertRow888() bit for bit against
+*			TestConvert565() for every row length up to
+*			CONVERT_PIXELS, both destination alignments, all 4x4
+*			dither phases and with dithering off, and that nothing is
+*			written past the row. The source mixes random bytes with
+*			values near 255 where the dither saturates.
+*
+* Output: number of failed rows
+*
+********************************************************************/
+static WORD TestConvertRow888(void)
+{
+    BYTE src[3 * CONVERT_PIXELS];
+    WORD dst[CONVERT_PIXELS + 4];
+    DWORD seed = 1;
+    WORD i, count, failures = 0;
+    SHORT x, y;
+    BYTE offset, dither, ok;
+
+    for(i=0; i<sizeof(src); i++)
+    {
+        seed = seed * 1103515245ul + 12345;
+        src[i] = (i % 5 == 0)? 248 + (BYTE)(seed >> 16) % 8 : (BYTE)(seed >> 16);
+    }
+
+    for(count=0; count<=CONVERT_PIXELS; count++)
+        for(offset=0; offset<2; offset++)
+            for(dither=0; dither<2; dither++)
+                for(y=0; y<4; y++)
+                    for(x=0; x<4; x++)
+                    {
+                        for(i=0; i<sizeof(dst)/sizeof(dst[0]); i++)
+                            dst[i] = CONVERT_GUARD;
+                        SSD2805ConvertRow888(dst + offset, src, count, x, y, dither);
+                        ok = (offset == 0) || (dst[0] == CONVERT_GUARD);
+                        for(i=0; i<count; i++)
+                            ok &= (dst[offset + i] == TestConvert565(src + 3 * i, x + i, y, dither));
+                        for(i=offset + count; i<sizeof(dst)/sizeof(dst[0]); i++)
+                            ok &= (dst[i] == CONVERT_GUARD);
+                        if(!ok)
+                        {
+                            printf("convert FAIL, %u pixels at x %d y %d, offset %u, dither %u\n", count, x, y, offset, dither);
+                            failures++;
+                        }
+                    }
+    if(failures == 0)
+        printf("convert  ok, rows of 0 to %u pixels\n", CONVERT_PIXELS);
+    return (failures);
+}
+
+/*********************************************************************
+* Overview: A draw sequence for the timing check, the pixels of each of
+*           its memory writes as SSD2805EstimateSequence() takes them
+*
+*********************************************************************/
+typedef struct
+{
+    const char  *name;
+    void        (*draw)(void);
+    WORD        count;              // memory writes
+    DWORD       pixels[3];          // pixels of each
+} TEST_TIMING;
+
+// prediction and model may differ by 1/TIMING_TOLERANCE, register
+// writes elided by the driver and core timer reads are not predicted
+#define TIMING_TOLERANCE    100
+
+static void TimingClear(void)
+{
+    SetColor(RGBConvert(0x20, 0x40, 0x80));
+    ClearDevice();
+}
+
+static void TimingBursts(void)
+{
+    SetColor(RGBConvert(0xFF, 0x00, 0x00));
+    SSD2805QueueBurst(10, 10, 109, 59, NULL);
+    SetColor(RGBConvert(0x00, 0xFF, 0x00));
+    SSD2805QueueBurst(130, 10, 229, 59, NULL);
+    SetColor(RGBConvert(0x00, 0x00, 0xFF));
+    SSD2805QueueBurst(10, 70, 229, 79, NULL);
+    SSD2805PresentFrame();
+}
+
+static const TEST_TIMING _timings[] =
+{
+    {"clear",   TimingClear,    1, {240*240}},
+    {"bursts",  TimingBursts,   3, {100*50, 100*50, 220*10}},
+};
+
+/*********************************************************************
+* Function: static BYTE TestWithin(DWORD predicted, DWORD measured)
+*
+* Output: 1 if predicted is within TIMING_TOLERANCE of measured
+*
+********************************************************************/
+static BYTE TestWithin(DWORD predicted, DWORD measured)
+{
+    DWORD diff = (predicted > measured)? predicted - measured : measured - predicted;
+
+    return (diff * TIMING_TOLERANCE <= measured);
+}
+
+/*********************************************************************
+* Function: static WORD TestTiming(void)
+*
+* Overview: runs the sequences of _timings[] and checks the estimate
+*			of SSD2805EstimateSequence(), with the parameters of
+*			SSD2805GetTimingParams(), against the model: bus bytes and
+*			core timer ticks within TIMING_TOLERANCE, MIPI packets
+*			exactly. The bus cycle is set to 1us so that the MCU time
+*			of the estimate counts bus cycles.
+*
+* Output: number of failed sequences
+*
+********************************************************************/
+static WORD TestTiming(void)
+{
+    SSD2805_TIMING_PARAMS params;
+    SSD2805_TIMING_ESTIMATE est;
+    SSD2805_MODEL_STATS stats;
+    DWORD bytes[3], cycles;
+    unsigned int ticks;
+    BYTE pixelBytes = (SSD2805GetPixelFormat() == SSD2805_PIXEL_FORMAT_16)? 2 : 3;
+    WORD i, j, failures = 0;
+
+    SSD2805GetTimingParams(&params);
+    params.busClockHz = 0;
+    params.spiClockHz = 0;
+    params.cpuNsPerCycle = 1000;
+
+    for(i=0; i<sizeof(_timings)/sizeof(_timings[0]); i++)
+    {
+        const TEST_TIMING *pTiming = &_timings[i];
+
+        for(j=0; j<pTiming->count; j++)
+            bytes[j] = pTiming->pixels[j] * pixelBytes;
+        SSD2805EstimateSequence(&params, bytes, pTiming->count, &est);
+        cycles = est.mcuNs / 1000;
+
+        SSD2805ModelClearStats();
+        ticks = SSD2805ModelTicks();
+        pTiming->draw();
+        ticks = SSD2805ModelTicks() - ticks - SSD2805_MODEL_TICKS_PER_READ;
+        SSD2805ModelGetStats(&stats);
+
+        if(!TestWithin(cycles * params.busBytes, stats.bytesWritten + stats.bytesRead) ||
+           !TestWithin(cycles * SSD2805_MODEL_TICKS_PER_CYCLE, ticks) || (est.packets != stats.linkPackets))
+        {
+            printf("timing FAIL, %s", pTiming->name);
+            failures++;
+        }
+        else
+            printf("timing   ok, %s", pTiming->name);
+        printf(", bytes %lu of %lu, ticks %lu of %u, packets %lu of %lu\n",
+                (unsigned long)(cycles * params.busBytes), (unsigned long)(stats.bytesWritten + stats.bytesRead),
+                (unsigned long)(cycles * SSD2805_MODEL_TICKS_PER_CYCLE), ticks,
+                (unsigned long)est.packets, (unsigned long)stats.linkPackets);
+    }
+    return (failures);
+}
+
+int main(int argc, char *argv[])
+{
+    SSD2805_MODEL_STATS stats;
+    char path[64];
+    BYTE update = (argc > 1) && !strcmp(argv[1], "-u");
+    WORD i, failures = 0;
+    DWORD diff, overheadWritten, overheadRead;
+    BYTE pixels, budget;
+
+    failures += TestConvertRow888();
+
+    SSD2805ModelReset();
+    ResetDevice();
+    SSD2805ModelGetStats(&stats);
+    if(stats.protocolErrors || stats.pixelsOutside)
+    {
+        printf("init: %lu protocol errors, %lu pixels outside\n", (unsigned long)stats.protocolErrors, (unsigned long)stats.pixelsOutside);
+        failures++;
+    }
+    failures += TestTiming();
+
+    for(i=0; i<sizeof(_scenes)/sizeof(_scenes[0]); i++)
+    {
+        const TEST_SCENE *pScene = &_scenes[i];
+        BYTE ok;
+
+        SSD2805ModelFill(0);
+        SSD2805ModelClearStats();
+        ok = pScene->draw();
+        SSD2805ModelGetStats(&stats);
+
+        overheadWritten = stats.bytesWritten - stats.pixelBytesWritten;
+        overheadRead = (stats.bytesRead > stats.pixelBytesRead)? stats.bytesRead - stats.pixelBytesRead : 0;
+        sprintf(path, REFERENCE_DIR "%s.ppm", pScene->name);
+
+        if(update)
+        {
+            TestWriteImage(path);
+            printf("%-8s pixels written %lu, read %lu, overhead written %lu, read %lu\n", pScene->name,
+                    (unsigned long)stats.pixelsWritten, (unsigned long)stats.pixelsRead,
+                    (unsigned long)overheadWritten, (unsigned long)overheadRead);
+            continue;
+        }
+
+        diff = TestCompareImage(path);
+        if(diff)
+        {
+            sprintf(path, "%s.out.ppm", pScene->name);
+            TestWriteImage(path);
+        }
+        pixels = (stats.pixelsWritten == pScene->pixelsWritten) && (stats.pixelsRead == pScene->pixelsRead);
+        budget = (overheadWritten <= pScene->overheadWritten) && (overheadRead <= pScene->overheadRead);
+        if(!ok || diff || stats.protocolErrors || stats.pixelsOutside || stats.pixelBytesDropped || !pixels || !budget)
+        {
+            printf("%-8s FAIL", pScene->name);
+            if(!ok)
+                printf(", read back");
+            if(diff)
+                printf(", %lu pixels differ, see %s", (unsigned long)diff, path);
+            if(stats.protocolErrors || stats.pixelsOutside)
+                printf(", %lu protocol errors, %lu pixels outside", (unsigned long)stats.protocolErrors, (unsigned long)stats.pixelsOutside);
+            if(stats.pixelBytesDropped)
+                printf(", %lu pixel bytes past TDC", (unsigned long)stats.pixelBytesDropped);
+            if(!pixels)
+                printf(", pixels written %lu/%lu, read %lu/%lu", (unsigned long)stats.pixelsWritten, (unsigned long)pScene->pixelsWritten,
+                        (unsigned long)stats.pixelsRead, (unsigned long)pScene->pixelsRead);
+            if(!budget)
+                printf(", overhead written %lu/%lu, read %lu/%lu", (unsigned long)overheadWritten, (unsigned long)pScene->overheadWritten,
+                        (unsigned long)overheadRead, (unsigned long)pScene->overheadRead);
+            printf("\n");
+            failures++;
+        }
+        else
+            printf("%-8s ok, overhead written %lu of %lu, read %lu of %lu\n", pScene->name,
+                    (unsigned long)overheadWritten, (unsigned long)pScene->overheadWritten,
+                    (unsigned long)overheadRead, (unsigned long)pScene->overheadRead);
+    }
+    return ((failures)? 1 : 0);
+}
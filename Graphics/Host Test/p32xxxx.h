@@ -0,0 +1,83 @@
+/*********************************************************************
+ *
+ *	Host stand-in for the XC32 device header
+ *
+ *********************************************************************
+ * FileName:        p32xxxx.h
+ * Processor:       host PC
+ * Compiler:        gcc
+ * Company:         TechToys Company
+ *
+ * Software License Agreement
+ *
+ * You should refer to the license agreement accompanying this
+ * Software for additional information regarding your rights and
+ * obligations.
+ *
+ ********************************************************************/
+/*
+*********************************************************************
+* Only the SFRs the SSD2805 driver touches in the host profile are
+* declared, as plain variables defined in SSD2805Model.c. A whole
+* register and its bit fields are separate variables here, the
+* driver only writes the whole register to clear it. PMMODEbits.BUSY
+* is never set, bus cycles complete in SSD2805ModelWrite()/Read().
+*********************************************************************
+*/
+#ifndef _HOST_P32XXXX_H
+#define _HOST_P32XXXX_H
+
+#define __C32_VERSION__     120
+
+typedef struct
+{
+    unsigned WAITE:2;
+    unsigned WAITM:4;
+    unsigned WAITB:2;
+    unsigned MODE:2;
+    unsigned MODE16:1;
+    unsigned INCM:2;
+    unsigned IRQM:2;
+    unsigned BUSY:1;
+} __PMMODEbits_t;
+
+typedef struct
+{
+    unsigned RDSP:1;
+    unsigned WRSP:1;
+    unsigned :1;
+    unsigned CS1P:1;
+    unsigned CS2P:1;
+    unsigned ALP:1;
+    unsigned CSF:2;
+    unsigned PTRDEN:1;
+    unsigned PTWREN:1;
+    unsigned PMPTTL:1;
+    unsigned ADRMUX:2;
+    unsigned SIDL:1;
+    unsigned :1;
+    unsigned PMPEN:1;
+} __PMCONbits_t;
+
+typedef struct
+{
+    unsigned PTEN0:1;
+    unsigned PTEN1:1;
+    unsigned PTEN2:1;
+    unsigned PTEN3:1;
+    unsigned PTEN4:1;
+    unsigned :11;
+} __PMAENbits_t;
+
+extern volatile unsigned int    PMMODE;
+extern volatile __PMMODEbits_t  PMMODEbits;
+extern volatile unsigned int    PMCON;
+extern volatile __PMCONbits_t   PMCONbits;
+extern volatile unsigned int    PMAEN;
+extern volatile __PMAENbits_t   PMAENbits;
+extern volatile unsigned int    PMADDR;
+extern volatile unsigned int    PMDIN;
+
+#define Nop()               ((void)0)
+
+#endif // _HOST_P32XXXX_H
@@ -0,0 +1,34 @@
+/*********************************************************************
+ *
+ *	Host stand-in for the PIC32 peripheral library header
+ *
+ *********************************************************************
+ * FileName:        plib.h
+ * Processor:       host PC
+ * Compiler:        gcc
+ * Company:         TechToys Company
+ *
+ * Software License Agreement
+ *
+ * You should refer to the license agreement accompanying this
+ * Software for additional information regarding your rights and
+ * obligations.
+ *
+ ********************************************************************/
+/*
+*********************************************************************
+* The core timer is the clock of the bus model, each read advances it
+* so that delays, deadlines and frame pacing run to completion.
+* There are no interrupts on the host.
+*********************************************************************
+*/
+#ifndef _HOST_PLIB_H
+#define _HOST_PLIB_H
+
+#include "SSD2805Model.h"
+
+#define ReadCoreTimer()             SSD2805ModelTicks()
+#define INTDisableInterrupts()      (0u)
+#define INTRestoreInterrupts(x)     ((void)(x))
+
+#endif // _HOST_PLIB_H
@@ -54,4 +54,33 @@
 *********************************************************************/
 #define COLOR_DEPTH             16
 
+/*********************************************************************
+* Overview: SSD2805PresentFrame() paces frames at SSD2805_FRAME_RATE and
+*           defers low priority bursts that do not fit the frame budget.
+*           Comment out to present queued bursts immediately.
+*
+*********************************************************************/
+#define USE_SSD2805_FRAME_SCHEDULER
+#define SSD2805_FRAME_RATE      30
+
+/*********************************************************************
+* Overview: Records the bus traffic of the SSD2805 driver in a RAM ring
+*           buffer of SSD2805_TRACE_SIZE entries, read it back with
+*           SSD2805TraceDump(). SSD2805_TRACE_LITE records DCS packets
+*           and bursts only, cheap enough to leave on in the field.
+*           Nothing is compiled in when USE_SSD2805_TRACE is not defined.
+*
+*********************************************************************/
+//#define USE_SSD2805_TRACE
+//#define SSD2805_TRACE_LITE
+#define SSD2805_TRACE_SIZE      64
+
+/*********************************************************************
+* Overview: Cumulative bus counters of the SSD2805 driver, read them
+*           with SSD2805GetPerfCounters(). Comment out to remove the
+*           counting code.
+*
+*********************************************************************/
+#define USE_SSD2805_PERF_COUNTERS
+
 #endif // _GRAPHICSCONFIG_H
@@ -125,11 +125,16 @@
 
 #define GFX_USE_SSD2805_MIPI_BRIDGE
 #define USE_GFX_PMP		//use 8080-addressing, it is PMP for Microchip
+//#define USE_GFX_SPI		//use 4-wire 8-bit SPI for configuration, pixel data from RGB interface
 
 //Two possible MCU interfaces, 8-bit 8080 or 16-bit 8080
 //It is important to change dip switch for PS[3:2]
+//With USE_GFX_SPI the SSD2805 is configured over SPI and runs in video mode,
+//display data is streamed by an external RGB source (PCLK, HSYNC, VSYNC, DE, D[23:0]).
 #if defined (USE_GFX_PMP)
 #define USE_SSD2805_CMD_MODE
+#elif defined (USE_GFX_SPI)
+#define USE_SSD2805_VIDEO_MODE
 #endif
 
 #define GFX_USE_DISPLAY_PANEL_TFT_LH154Q01	//LG 1.54" TFT in 1-lane Mipi interface 240x240
@@ -142,6 +147,16 @@
     #define DISP_HOR_RESOLUTION 240
     #define DISP_VER_RESOLUTION 240
     #define GFX_LCD_TYPE            GFX_LCD_TFT
+
+    // RGB timing used by SSD2805 in video mode (USE_SSD2805_VIDEO_MODE only).
+    // Values are in PCLK for horizontal and in lines for vertical timing,
+    // they must match the RGB source driving the SSD2805 parallel port.
+    #define DISP_HOR_PULSE_WIDTH    10
+    #define DISP_HOR_BACK_PORCH     20
+    #define DISP_HOR_FRONT_PORCH    20
+    #define DISP_VER_PULSE_WIDTH    2
+    #define DISP_VER_BACK_PORCH     8
+    #define DISP_VER_FRONT_PORCH    8
 #endif
 
 
@@ -172,30 +187,117 @@
 
 		//For some unknown reason, it is not possible to set RC2 as GPIO when PMP module is enabled
 		//To work around RC2 is set as PMA2 address line.
+		#if defined (USE_GFX_PMP)
                 #define SSD_ResetConfig()        	{TRISCbits.TRISC4  = 0; PMAENbits.PTEN4 = 1;}
 		#define SSD_ResetEnable()		PMADDR &= 0xffef	//PMA4 set 0
 		#define SSD_ResetDisable() 		PMADDR |= 0x0010	//PMA4 set 1
+		#else	//PMP is off in SPI mode, RC4 is a plain GPIO
+                #define SSD_ResetConfig()        	TRISCbits.TRISC4  = 0
+		#define SSD_ResetEnable()		LATCbits.LATC4 = 0
+		#define SSD_ResetDisable() 		LATCbits.LATC4 = 1
+		#endif
 
                 //definitions for DisplayResetXXXX() to maintain consistency in gfxpmp.h only
                 #define DisplayResetConfig()    SSD_ResetConfig()
                 #define DisplayResetEnable()    SSD_ResetEnable()
                 #define DisplayResetDisable()   SSD_ResetDisable()
 
-        // Definitions for backlight control pin
+
+		// -----------------------------------
+		// SSD2805 clock configuration
+		// -----------------------------------
+		// fPLL = SSD_TX_CLK_MHZ*SSD_PLL_MUL/(SSD_PLL_PDIV*SSD_PLL_DIV) is the HS bit rate
+		// per lane, 225MHz..350MHz. Either set SSD_HS_LANE_MBPS and let SSD_PLL_MUL be
+		// derived, or define SSD_PLL_MUL directly. Ranges are checked in SSD2805.h.
+		// LP clock = fPLL/(8*SSD_LP_DIV), max. 10MHz, check panel spec (8MHz for LH154Q01)
+		// SYS_CLK = SSD_TX_CLK_MHZ/SSD_SYS_CLK_DIV, output on SYS_CLK pin for debug
+		#define SSD_TX_CLK_MHZ              20
+		#define SSD_HS_LANE_MBPS            320
+		#define SSD_PLL_PDIV                1
+		#define SSD_PLL_DIV                 1
+		#define SSD_LP_DIV                  5
+		#define SSD_SYS_CLK_DIV             2
+
+		// -----------------------------------
+		// Tearing effect (TE) synchronization
+		// -----------------------------------
+		// TE pin of the bridge board wired to Input Capture 1. Comment out
+		// USE_SSD2805_TE_SYNC if TE is not connected, SSD2805PresentFrame()
+		// then writes queued bursts immediately. ResetDevice() turns TE on
+		// at the end of initialization. SSD2805_TE_BLANK_LINES is the
+		// V-blank of the panel in lines, TE rises at its start.
+		#define USE_SSD2805_TE_SYNC
+		#define SSD2805_TE_BLANK_LINES      16
+		#define SSD_TE_ICCON                IC1CON
+		#define SSD_TE_ICCONbits            IC1CONbits
+		#define SSD_TE_ICBUF                IC1BUF
+		#define SSD_TE_IF                   IFS0bits.IC1IF
+		#define SSD_TE_IE                   IEC0bits.IC1IE
+		#define SSD_TE_IP                   IPC1bits.IC1IP
+		#define SSD_TE_VECTOR               _INPUT_CAPTURE_1_VECTOR
+		#define SSD_TEPinConfig()           {TRISBbits.TRISB2 = 1; ANSELBbits.ANSB2 = 0; IC1R = 0x04;}	//TE on RPB2
+
+		// -----------------------------------
+		// Interrupt driven PMP transfers
+		// -----------------------------------
+		// Pixel data and long parameter blocks are written from the PMP
+		// interrupt, one strobe per interrupt, instead of spinning on
+		// PMMODEbits.BUSY. Only worth it with slow bus timing, see
+		// SSD2805.h. Uncomment USE_SSD2805_PMP_IRQ to enable.
+		#if defined (USE_GFX_PMP)
+		//#define USE_SSD2805_PMP_IRQ
+		#define SSD_PMP_IF                  IFS1bits.PMPIF
+		#define SSD_PMP_IE                  IEC1bits.PMPIE
+		#define SSD_PMP_IP                  IPC8bits.PMPIP
+		#define SSD_PMP_VECTOR              _PMP_VECTOR
+		#endif
+
+		// -----------------------------------
+		// PWM backlight
+		// -----------------------------------
+		// Backlight enable on RC3 driven by OC4 (RPC3R = 0101) with Timer2
+		// as time base. The Timer2 interrupt runs only during fades.
+		// Comment out USE_SSD2805_BACKLIGHT_PWM to keep RC3 a plain GPIO,
+		// SSD2805SetBacklight() then uses the panel brightness (DCS 0x51).
+		#define USE_SSD2805_BACKLIGHT_PWM
+		#define SSD_BL_OCCON                OC4CON
+		#define SSD_BL_OCCONbits            OC4CONbits
+		#define SSD_BL_OCR                  OC4R
+		#define SSD_BL_OCRS                 OC4RS
+		#define SSD_BL_TMRCON               T2CON
+		#define SSD_BL_TMRCONbits           T2CONbits
+		#define SSD_BL_TMR                  TMR2
+		#define SSD_BL_PR                   PR2
+		#define SSD_BL_OCTSEL               0		//OCxCON.OCTSEL 0 for Timer2
+		#define SSD_BL_IF                   IFS0bits.T2IF
+		#define SSD_BL_IE                   IEC0bits.T2IE
+		#define SSD_BL_IP                   IPC2bits.T2IP
+		#define SSD_BL_VECTOR               _TIMER_2_VECTOR
+		#define SSD_BLPinConfig()           {TRISCbits.TRISC3 = 0; ANSELCbits.ANSC3 = 0; RPC3R = 0x05;}	//OC4 on RPC3
+
+        // Definitions for backlight control pin, with the PWM RC3 is OC4
+        // and DisplayBacklightOn()/Off() set the PWM level
+		#if defined (USE_SSD2805_BACKLIGHT_PWM)
+        void SSD2805SetBacklight(unsigned char level);	//of SSD2805.h, used by gfxpmp.h before it is included
+        #define DisplayBacklightConfig()    SSD_BLPinConfig()
+        #define DisplayBacklightOn()        SSD2805SetBacklight(255)
+        #define DisplayBacklightOff()       SSD2805SetBacklight(0)
+		#else
         #define DisplayBacklightConfig()    {TRISCbits.TRISC3 = 0; ANSELCbits.ANSC3 = 0;}
         #define DisplayBacklightOn()        LATCbits.LATC3 = BACKLIGHT_ENABLE_LEVEL
         #define DisplayBacklightOff()       LATCbits.LATC3 = BACKLIGHT_DISABLE_LEVEL
+		#endif
 
 		/*
 		*****************************************************************
 		* Note: There are two operating clock speed before and after PLL
 		*		locked in SSD2805. External oscillator is 20MHz. After
 		*		PLL, the operating frequency can be as high as 500MHz.
-		*		PMP_DATA_SETUP_TIME, _WAIT_TIME, & _HOLD_TIME set here
-		*		fit the timing requirement before PLL is locked, therefore
-		*		they are timing for operating freq. @ 20MHz.
-		*		New PMP timing values are set in ResetDevice() of SSD2805.c
-		*		for faster data I/O after PLL is locked.
+		*		PMP_DATA_SETUP_TIME & _HOLD_TIME set here are board
+		*		minimums kept at both speeds. The WR#/RD# strobe is
+		*		computed in ResetDevice() of SSD2805.c from the 3T rule
+		*		for each clock and verified by a register read-back,
+		*		PMP_DATA_WAIT_TIME is not used by SSD2805.c.
 		*****************************************************************
 		*/
       	#if defined (USE_GFX_PMP)
@@ -214,6 +316,39 @@
 	//Remarks: WR# & RD# wired to RB3/PMWR & RB13/PMRD lines respectively
 	//WR# and RD# are strobed automatically by PMP module. No definition here is required.
 
+		#elif defined (USE_GFX_SPI)
+		/*
+		*****************************************************************
+		* SSD2805 in 4-wire 8-bit SPI mode (PS[3:0] set accordingly).
+		* SCK1 is RB14, SDO1/SDI1 are remapped by PPS in SSD_SPIPinConfig().
+		* SDC (data/command) & CSX are GPIO, reusing the PMA0 & CSX traces.
+		* Before PLL is locked SSD2805 runs from TX_CLK (20MHz), SPI clock
+		* is kept low; it is raised to SSD_SPI_CLOCK after PLL is locked.
+		*****************************************************************
+		*/
+            #define SSD_SPI_CLOCK_BEFORE_PLL    (2000000ul)
+            #define SSD_SPI_CLOCK               (10000000ul)
+
+            #define SSD_SPIBUF                  SPI1BUF
+            #define SSD_SPICON                  SPI1CON
+            #define SSD_SPICONbits              SPI1CONbits
+            #define SSD_SPISTATbits             SPI1STATbits
+            #define SSD_SPIBRG                  SPI1BRG
+            #define SSD_SPI_TX_IRQ              _SPI1_TX_IRQ    //DMA start event for block transfers
+
+            //DMA channel used for long parameter blocks, comment out to use CPU writes only
+            #define SSD_SPI_DMA_CHANNEL         0
+
+            #define SSD_SPIPinConfig()          {RPB13R = 0x03; SDI1R = 0x03;}	//SDO1 on RPB13, SDI1 on RPB11
+
+            #define DisplayCmdDataConfig()      TRISCbits.TRISC7 = 0
+            #define DisplaySetCommand()         LATCbits.LATC7 = 0
+            #define DisplaySetData()            LATCbits.LATC7 = 1
+
+            #define DisplayConfig()             {TRISBbits.TRISB15 = 0; ANSELBbits.ANSB15 = 0;} //CSX, chip select for MCU interface
+            #define DisplayEnable()             LATBbits.LATB15   = 0
+            #define DisplayDisable()            LATBbits.LATB15   = 1
+
 		#else
 			#error "USE_GFX_PMP is defined but no timing values are defined in hardware profile."
 		#endif	//#ifdef (USE_GFX_PMP)
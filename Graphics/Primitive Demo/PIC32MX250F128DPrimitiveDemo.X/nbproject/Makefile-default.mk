@@ -45,17 +45,17 @@ OBJECTDIR=build/${CND_CONF}/${IMAGE_TYPE}
 DISTDIR=dist/${CND_CONF}/${IMAGE_TYPE}
 
 # Source Files Quoted if spaced
-SOURCEFILES_QUOTED_IF_SPACED=../../../Microchip/Common/TimeDelay.c ../../../Microchip/Graphics/Drivers/SSD2805.c ../MainDemo.c
+SOURCEFILES_QUOTED_IF_SPACED=../../../Microchip/Common/TimeDelay.c ../../../Microchip/Graphics/Drivers/SSD2805.c ../../../Microchip/Graphics/Drivers/SSD2805Timing.c ../MainDemo.c
 
 # Object Files Quoted if spaced
-OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/_ext/1860783399/TimeDelay.o ${OBJECTDIR}/_ext/1919882987/SSD2805.o ${OBJECTDIR}/_ext/1472/MainDemo.o
-POSSIBLE_DEPFILES=${OBJECTDIR}/_ext/1860783399/TimeDelay.o.d ${OBJECTDIR}/_ext/1919882987/SSD2805.o.d ${OBJECTDIR}/_ext/1472/MainDemo.o.d
+OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/_ext/1860783399/TimeDelay.o ${OBJECTDIR}/_ext/1919882987/SSD2805.o ${OBJECTDIR}/_ext/1919882987/SSD2805Timing.o ${OBJECTDIR}/_ext/1472/MainDemo.o
+POSSIBLE_DEPFILES=${OBJECTDIR}/_ext/1860783399/TimeDelay.o.d ${OBJECTDIR}/_ext/1919882987/SSD2805.o.d ${OBJECTDIR}/_ext/1919882987/SSD2805Timing.o.d ${OBJECTDIR}/_ext/1472/MainDemo.o.d
 
 # Object Files
-OBJECTFILES=${OBJECTDIR}/_ext/1860783399/TimeDelay.o ${OBJECTDIR}/_ext/1919882987/SSD2805.o ${OBJECTDIR}/_ext/1472/MainDemo.o
+OBJECTFILES=${OBJECTDIR}/_ext/1860783399/TimeDelay.o ${OBJECTDIR}/_ext/1919882987/SSD2805.o ${OBJECTDIR}/_ext/1919882987/SSD2805Timing.o ${OBJECTDIR}/_ext/1472/MainDemo.o
 
 # Source Files
-SOURCEFILES=../../../Microchip/Common/TimeDelay.c ../../../Microchip/Graphics/Drivers/SSD2805.c ../MainDemo.c
+SOURCEFILES=../../../Microchip/Common/TimeDelay.c ../../../Microchip/Graphics/Drivers/SSD2805.c ../../../Microchip/Graphics/Drivers/SSD2805Timing.c ../MainDemo.c
 
 
 CFLAGS=
@@ -103,6 +103,12 @@ ${OBJECTDIR}/_ext/1919882987/SSD2805.o: ../../../Microchip/Graphics/Drivers/SSD2
 	@${RM} ${OBJECTDIR}/_ext/1919882987/SSD2805.o 
 	@${FIXDEPS} "${OBJECTDIR}/_ext/1919882987/SSD2805.o.d" $(SILENT) -rsi ${MP_CC_DIR}../  -c ${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_ICD3=1 -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION) -Os -I"../../Common" -I".." -I"../../../Board Support Package" -I"../../../Microchip/Include" -I"../../../Microchip/Include/Graphics" -I"../Configs" -I"../../../Microchip/Include/MDD File System" -I"../../../Microchip/Include/Image Decoders" -I"." -MMD -MF "${OBJECTDIR}/_ext/1919882987/SSD2805.o.d" -o ${OBJECTDIR}/_ext/1919882987/SSD2805.o ../../../Microchip/Graphics/Drivers/SSD2805.c   
 	
+${OBJECTDIR}/_ext/1919882987/SSD2805Timing.o: ../../../Microchip/Graphics/Drivers/SSD2805Timing.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} ${OBJECTDIR}/_ext/1919882987 
+	@${RM} ${OBJECTDIR}/_ext/1919882987/SSD2805Timing.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1919882987/SSD2805Timing.o 
+	@${FIXDEPS} "${OBJECTDIR}/_ext/1919882987/SSD2805Timing.o.d" $(SILENT) -rsi ${MP_CC_DIR}../  -c ${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_ICD3=1 -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION) -Os -I"../../Common" -I".." -I"../../../Board Support Package" -I"../../../Microchip/Include" -I"../../../Microchip/Include/Graphics" -I"../Configs" -I"../../../Microchip/Include/MDD File System" -I"../../../Microchip/Include/Image Decoders" -I"." -MMD -MF "${OBJECTDIR}/_ext/1919882987/SSD2805Timing.o.d" -o ${OBJECTDIR}/_ext/1919882987/SSD2805Timing.o ../../../Microchip/Graphics/Drivers/SSD2805Timing.c   
+	
 ${OBJECTDIR}/_ext/1472/MainDemo.o: ../MainDemo.c  nbproject/Makefile-${CND_CONF}.mk
 	@${MKDIR} ${OBJECTDIR}/_ext/1472 
 	@${RM} ${OBJECTDIR}/_ext/1472/MainDemo.o.d 
@@ -122,6 +128,12 @@ ${OBJECTDIR}/_ext/1919882987/SSD2805.o: ../../../Microchip/Graphics/Drivers/SSD2
 	@${RM} ${OBJECTDIR}/_ext/1919882987/SSD2805.o 
 	@${FIXDEPS} "${OBJECTDIR}/_ext/1919882987/SSD2805.o.d" $(SILENT) -rsi ${MP_CC_DIR}../  -c ${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION) -Os -I"../../Common" -I".." -I"../../../Board Support Package" -I"../../../Microchip/Include" -I"../../../Microchip/Include/Graphics" -I"../Configs" -I"../../../Microchip/Include/MDD File System" -I"../../../Microchip/Include/Image Decoders" -I"." -MMD -MF "${OBJECTDIR}/_ext/1919882987/SSD2805.o.d" -o ${OBJECTDIR}/_ext/1919882987/SSD2805.o ../../../Microchip/Graphics/Drivers/SSD2805.c   
 	
+${OBJECTDIR}/_ext/1919882987/SSD2805Timing.o: ../../../Microchip/Graphics/Drivers/SSD2805Timing.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} ${OBJECTDIR}/_ext/1919882987 
+	@${RM} ${OBJECTDIR}/_ext/1919882987/SSD2805Timing.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1919882987/SSD2805Timing.o 
+	@${FIXDEPS} "${OBJECTDIR}/_ext/1919882987/SSD2805Timing.o.d" $(SILENT) -rsi ${MP_CC_DIR}../  -c ${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION) -Os -I"../../Common" -I".." -I"../../../Board Support Package" -I"../../../Microchip/Include" -I"../../../Microchip/Include/Graphics" -I"../Configs" -I"../../../Microchip/Include/MDD File System" -I"../../../Microchip/Include/Image Decoders" -I"." -MMD -MF "${OBJECTDIR}/_ext/1919882987/SSD2805Timing.o.d" -o ${OBJECTDIR}/_ext/1919882987/SSD2805Timing.o ../../../Microchip/Graphics/Drivers/SSD2805Timing.c   
+	
 ${OBJECTDIR}/_ext/1472/MainDemo.o: ../MainDemo.c  nbproject/Makefile-${CND_CONF}.mk
 	@${MKDIR} ${OBJECTDIR}/_ext/1472 
 	@${RM} ${OBJECTDIR}/_ext/1472/MainDemo.o.d 
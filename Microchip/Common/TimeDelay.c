@@ -38,6 +38,8 @@ Date        Comments
 2010.01.26	Converted locals to volatile 
 2010.03.07	Added include "Compiler.h"
 2010.10.13  Added PICC support
+2014.02.12  PIC32 delays timed by the core timer instead of cycle counting,
+            added timestamps, deadlines and DelayMsYield()
 *******************************************************************************/
 #if defined(__PIC32MX__)
 	#include <plib.h>
@@ -46,6 +48,39 @@ Date        Comments
 #include "HardwareProfile.h"
 #include "TimeDelay.h" 
 
+#if defined(__PIC32MX__)
+static void (*_timeYieldHook)(void);
+
+// longest single wait, well below half the core timer wrap period
+#define TIME_MAX_WAIT_MS        1000
+
+/****************************************************************************
+  Function:
+    static void TimeWaitMs( UINT32 ms, BOOL yield )
+
+  Description:
+    Waits on the core timer in steps of at most TIME_MAX_WAIT_MS so that
+    the signed deadline compare cannot overflow at any system clock.
+  ***************************************************************************/
+static void TimeWaitMs( UINT32 ms, BOOL yield )
+{
+    TIME_DEADLINE deadline;
+    UINT32 step;
+
+    while(ms)
+    {
+        step = (ms > TIME_MAX_WAIT_MS)? TIME_MAX_WAIT_MS : ms;
+        ms -= step;
+        deadline = TimeDeadlineMs(step);
+        while(!TimeDeadlineExpired(deadline))
+        {
+            if(yield)
+                TimeYield();
+        }
+    }
+}
+#endif
+
 /****************************************************************************
   Function:
     void Delay10us( UINT32 tenMicroSecondCounter )
@@ -68,7 +103,9 @@ Date        Comments
   ***************************************************************************/
 void Delay10us( UINT32 tenMicroSecondCounter )
 {
+    #if !defined(__PIC32MX__)
     volatile INT32 cyclesRequiredForEntireDelay;    
+    #endif
         
     #if defined(__18CXX) || defined (COMPILER_HITECH_PICC)
     
@@ -107,7 +144,16 @@ void Delay10us( UINT32 tenMicroSecondCounter )
             }
         }
     
-    #elif defined(__C30__) || defined(__PIC32MX__)
+    #elif defined(__PIC32MX__)
+
+        TIME_DEADLINE deadline;
+
+        // whole milliseconds first, then the remainder below 1ms
+        TimeWaitMs(tenMicroSecondCounter/100, FALSE);
+        deadline = TimeDeadlineUs((tenMicroSecondCounter%100)*10);
+        while(!TimeDeadlineExpired(deadline));
+
+    #elif defined(__C30__)
     
         if(GetInstructionClock() <= 500000) //for all FCY speeds under 500KHz (FOSC <= 1MHz)
         {
@@ -124,15 +170,9 @@ void Delay10us( UINT32 tenMicroSecondCounter )
             //We want to pre-calculate number of cycles required to delay 10us * tenMicroSecondCounter using a 1 cycle granule.
             cyclesRequiredForEntireDelay = (INT32)(GetInstructionClock()/100000)*tenMicroSecondCounter;
             
-            #if defined(__C30__)
-                //We subtract all the cycles used up until we reach the while loop below, where each loop cycle count is subtracted.
-                //Also we subtract the 5 cycle function return.
-                cyclesRequiredForEntireDelay -= 44; //(29 + 5) + 10 cycles padding
-            #elif defined(__PIC32MX__)
-                //We subtract all the cycles used up until we reach the while loop below, where each loop cycle count is subtracted.
-                //Also we subtract the 5 cycle function return.
-                cyclesRequiredForEntireDelay -= 24; //(19 + 5)
-            #endif
+            //We subtract all the cycles used up until we reach the while loop below, where each loop cycle count is subtracted.
+            //Also we subtract the 5 cycle function return.
+            cyclesRequiredForEntireDelay -= 44; //(29 + 5) + 10 cycles padding
             
             if(cyclesRequiredForEntireDelay <= 0)
             {
@@ -142,11 +182,7 @@ void Delay10us( UINT32 tenMicroSecondCounter )
             {   
                 while(cyclesRequiredForEntireDelay>0) //19 cycles used to this point.
                 {
-                    #if defined(__C30__)
-                        cyclesRequiredForEntireDelay -= 11; //Subtract cycles burned while doing each delay stage, 12 in this case. Add one cycle as padding.
-                    #elif defined(__PIC32MX__)
-                        cyclesRequiredForEntireDelay -= 8; //Subtract cycles burned while doing each delay stage, 8 in this case.
-                    #endif
+                    cyclesRequiredForEntireDelay -= 11; //Subtract cycles burned while doing each delay stage, 12 in this case. Add one cycle as padding.
                 }
             }
         }
@@ -198,7 +234,11 @@ void DelayMs( UINT16 ms )
             }
         }
         
-    #elif defined(__C30__) || defined(__PIC32MX__)
+    #elif defined(__PIC32MX__)
+
+        TimeWaitMs(ms, FALSE);
+
+    #elif defined(__C30__)
     
         volatile UINT8 i;
         
@@ -213,3 +253,123 @@ void DelayMs( UINT16 ms )
     #endif
 }
 
+#if defined(__PIC32MX__)
+/****************************************************************************
+  Function:
+    UINT32 TimeGetUs( void )
+
+  Description:
+    This routine returns a monotonic timestamp in microseconds.
+
+  Precondition:
+    None
+
+  Parameters:
+    None
+
+  Returns:
+    UINT32 - microseconds, wraps every 2^32 us (71 minutes)
+
+  Remarks:
+    Interrupts are disabled while the count is extended so the routine
+    may also be called from interrupt handlers.
+  ***************************************************************************/
+UINT32 TimeGetUs( void )
+{
+    static UINT32 lastTicks;
+    static UINT32 remainderTicks;
+    static UINT32 us;
+    UINT32 now, elapsed, status;
+
+    status = INTDisableInterrupts();
+    now = TimeGetTicks();
+    elapsed = now - lastTicks + remainderTicks;
+    lastTicks = now;
+    us += elapsed/TIME_TICKS_PER_US;
+    remainderTicks = elapsed%TIME_TICKS_PER_US;
+    now = us;
+    INTRestoreInterrupts(status);
+
+    return now;
+}
+
+/****************************************************************************
+  Function:
+    void TimeSetYieldHook( void (*hook)(void) )
+
+  Description:
+    This routine registers the cooperative task hook.
+
+  Precondition:
+    None
+
+  Parameters:
+    void (*hook)(void) - task hook, NULL to remove it
+
+  Returns:
+    None
+
+  Remarks:
+    None
+  ***************************************************************************/
+void TimeSetYieldHook( void (*hook)(void) )
+{
+    _timeYieldHook = hook;
+}
+
+/****************************************************************************
+  Function:
+    void TimeYield( void )
+
+  Description:
+    This routine calls the yield hook once, if one is registered.
+
+  Precondition:
+    None
+
+  Parameters:
+    None
+
+  Returns:
+    None
+
+  Remarks:
+    None
+  ***************************************************************************/
+void TimeYield( void )
+{
+    static BOOL inHook = FALSE;
+
+    if(_timeYieldHook && !inHook)
+    {
+        inHook = TRUE;              // no nesting if the hook itself waits
+        _timeYieldHook();
+        inHook = FALSE;
+    }
+}
+
+/****************************************************************************
+  Function:
+    void DelayMsYield( UINT16 ms )
+
+  Description:
+    This routine waits 'ms' milliseconds on the core timer, calling the
+    yield hook while waiting.
+
+  Precondition:
+    None
+
+  Parameters:
+    UINT16 ms - number of milliseconds to wait
+
+  Returns:
+    None
+
+  Remarks:
+    None
+  ***************************************************************************/
+void DelayMsYield( UINT16 ms )
+{
+    TimeWaitMs(ms, TRUE);
+}
+#endif
@@ -60,6 +60,12 @@
 #include "Graphics/DisplayDriver.h"
 #include "Graphics/SSD2805.h"
 
+// SSE2 kernels for the host build, XC32 never defines __SSE2__
+#if defined (__SSE2__) && !defined (SSD2805_NO_SIMD)
+#define SSD_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 // Clipping region control
 SHORT       _clipRgn;
 
@@ -79,43 +85,270 @@ SHORT       _colorTransparentEnable;
 //swap hi-byte to lo-byte and vice versa
 #define Swap(x) (((WORD_VAL)x).v[0]<<8 | (((WORD_VAL)x).v[1]&0x00FF))
 
+#ifdef USE_SSD2805_CMD_MODE
+static void SSD2805WriteBurst(const SSD2805_BURST *pBurst);
+#endif
+
+#if defined (USE_GFX_PMP) && defined (USE_SSD2805_PMP_IRQ)
+#if defined (USE_16BIT_PMP)
+typedef WORD			SSD_PMP_CELL;		// one PMP cycle
+#else
+typedef BYTE			SSD_PMP_CELL;
+#endif
+
+static const SSD_PMP_CELL * volatile _pmpTxData;	// source, NULL to repeat _pmpTxColor
+static volatile DWORD	_pmpTxCount;		// PMP cycles still to write
+static volatile WORD	_pmpTxColor;
+static volatile BYTE	_pmpTxBusy;			// chip select held by the interrupt transfer
+
+/*********************************************************************
+* Function: static void SSD2805PMPTxNext(void)
+*
+* Overview: starts the next PMP write cycle of the interrupt transfer.
+*			In 8-bit mode a repeated color is sent low byte first, the
+*			low byte goes out while an even number of cycles is left.
+*
+********************************************************************/
+static inline void __attribute__ ((always_inline)) SSD2805PMPTxNext(void)
+{
+	if(_pmpTxData)
+		PMDIN = *_pmpTxData++;
+	else
+	#if defined (USE_16BIT_PMP)
+		PMDIN = _pmpTxColor;
+	#else
+		PMDIN = (_pmpTxCount & 1)? (BYTE)(_pmpTxColor>>8) : (BYTE)_pmpTxColor;
+	#endif
+	_pmpTxCount--;
+}
+
+/*********************************************************************
+* Function: void SSD2805PMPHandler(void)
+*
+* Overview: PMP interrupt at the end of each write cycle. Starts the
+*			next cycle, or releases chip select after the last one.
+*
+********************************************************************/
+void __ISR(SSD_PMP_VECTOR, IPL4AUTO) SSD2805PMPHandler(void)
+{
+	SSD_PMP_IF = 0;
+	if(_pmpTxCount)
+	{
+		SSD2805PMPTxNext();
+	}
+	else
+	{
+		SSD_PMP_IE = 0;
+		DisplayDisable();
+		_pmpTxBusy = 0;
+	}
+}
+
+/*********************************************************************
+* Function: static void SSD2805PMPTxStart(const void *pData, WORD color, DWORD cycles)
+*
+* Overview: starts an interrupt driven write of 'cycles' PMP cycles
+*			from pData, or of 'color' repeated if pData is NULL, and
+*			returns at once. Chip select must be enabled and SDC set
+*			for data, it is released by the interrupt when done.
+*
+* Note: pData must stay valid until IsDeviceBusy() returns 0
+*
+********************************************************************/
+static void SSD2805PMPTxStart(const void *pData, WORD color, DWORD cycles)
+{
+	if(cycles == 0)
+	{
+		DisplayDisable();
+		return;
+	}
+	_pmpTxData = (const SSD_PMP_CELL *)pData;
+	_pmpTxColor = color;
+	_pmpTxCount = cycles;
+	_pmpTxBusy = 1;
+
+	SSD_PMP_IF = 0;
+	SSD_PMP_IP = 4;							//same as IPL4AUTO of the handler
+	SSD2805PMPTxNext();
+	SSD_PMP_IE = 1;							//flag is set at the end of the first cycle
+}
+
+/*********************************************************************
+* Macro: SSD2805TxWait()
+*
+* Overview: waits for an interrupt transfer to finish. Every access
+*			that takes the chip select calls it first.
+*
+********************************************************************/
+#define SSD2805TxWait()		{ while(_pmpTxBusy) TimeYield(); }
+#else
+#define SSD2805TxWait()
+#endif
+
+#ifdef USE_SSD2805_TRACE
+static SSD2805_TRACE_ENTRY	_trace[SSD2805_TRACE_SIZE];
+static DWORD				_traceCount;		// entries recorded since SSD2805TraceClear()
+static DWORD_VAL			_traceTdc;			// last TDC size written to 0xBC/0xBD
+
+/*********************************************************************
+* Function: static void SSD2805TraceAdd(BYTE type, BYTE code, DWORD value)
+*
+* Overview: records one entry, overwriting the oldest when full
+*
+********************************************************************/
+static inline void SSD2805TraceAdd(BYTE type, BYTE code, DWORD value)
+{
+	SSD2805_TRACE_ENTRY *pEntry = &_trace[_traceCount & (SSD2805_TRACE_SIZE - 1)];
+
+	pEntry->time = TimeGetTicks();
+	pEntry->value = value;
+	pEntry->type = type;
+	pEntry->code = code;
+	_traceCount++;
+}
+
+#define SSD_TRACE(type, code, value)		SSD2805TraceAdd(type, code, value)
+#ifdef SSD2805_TRACE_LITE
+#define SSD_TRACE_FULL(type, code, value)	((void)0)
+#else
+#define SSD_TRACE_FULL(type, code, value)	SSD2805TraceAdd(type, code, value)
+#endif
+#else
+#define SSD_TRACE(type, code, value)		((void)0)
+#define SSD_TRACE_FULL(type, code, value)	((void)0)
+#endif
+
+#ifdef USE_SSD2805_PERF_COUNTERS
+static SSD2805_PERF_COUNTERS	_perf;
+DWORD					_ssd2805BusyTicks;		// timed by PMPWaitBusy()/SPIWaitBusy() in SSD2805.h
+
+#define SSD_PERF(counter, n)	_perf.counter += (n)
+#else
+#define SSD_PERF(counter, n)	((void)0)
+#endif
+
+#if defined (USE_16BIT_PMP)
+#define SSD_BUS_BYTES			2				// bytes per data cycle
+#else
+#define SSD_BUS_BYTES			1
+#endif
+
+// TDC of a memory write of n bytes. With 16-bit PMP an odd burst of
+// 3-byte pixels ends in a padded cycle, TDC counts the pad so that all
+// bytes sent are in the packet. The panel drops the incomplete pixel.
+#define SSD_BUS_PADDED(n)		(((n) + SSD_BUS_BYTES - 1) & ~(DWORD)(SSD_BUS_BYTES - 1))
+
+// Shadow of the cacheable local registers, see SSD2805ShadowIndex()
+#define SSD_SHADOW_SIZE			14
+static WORD		_regShadow[SSD_SHADOW_SIZE];
+static WORD		_regShadowValid;				// bit n set when _regShadow[n] matches the register
+
+/*********************************************************************
+* Function: static BYTE SSD2805ShadowIndex(BYTE reg)
+*
+* Overview: maps a local register to its shadow entry. Only registers
+*			that read back what was written and have no side effect
+*			on write are cached: 0xB1-0xB8 (video timing, packet
+*			format, VC), 0xBA-0xBE (PLL, clock, TDC, threshold) and
+*			0xD6. 0xB9 (PLL enable) is always written.
+*
+* Output: shadow index, 0xFF if the register is not cached
+*
+********************************************************************/
+static BYTE SSD2805ShadowIndex(BYTE reg)
+{
+	if((reg >= 0xb1) && (reg <= 0xb8))
+		return (reg - 0xb1);
+	if((reg >= 0xba) && (reg <= 0xbe))
+		return (reg - 0xba + 8);
+	if(reg == 0xd6)
+		return (13);
+	return (0xFF);
+}
+
 
 inline void SSD2805WriteCmd(BYTE cmd)
 {
-#ifdef USE_SSD2805_CMD_MODE
+	if((cmd < 0xB0) || (cmd > 0xD9))		//local registers are counted by SSD2805WriteReg()
+	{
+		SSD_TRACE(SSD2805_TRACE_DCS, cmd, _traceTdc.Val);
+		SSD_PERF(dcsCommands, 1);
+	}
+	SSD_PERF(bytesWritten, 1);
+	SSD2805TxWait();
 	DisplayEnable();
 	DisplaySetCommand();
-	DeviceWrite(cmd);	//pmp write in 8080 addressing
+	DeviceWrite(cmd);	//pmp write in 8080 addressing, or SPI byte with SDC low in video mode
 	DisplayDisable();
-#elif defined USE_SSD2805_VIDEO_MODE
-	//config via SPI mode
-#endif
 }
 
-#ifdef USE_SSD2805_CMD_MODE
-	#if defined (USE_16BIT_PMP)
+#if defined (USE_16BIT_PMP)
 	inline void SSD2805WriteData(WORD data)
 	{
+		SSD_PERF(bytesWritten, SSD_BUS_BYTES);
+		SSD2805TxWait();
 		DisplayEnable();
 		DisplaySetData();
 		DeviceWrite(data);
 		DisplayDisable();
 	}
-	//#elif defined (USE_8BIT_PMP)
-	#else
+//#elif defined (USE_8BIT_PMP) || defined (USE_SSD2805_VIDEO_MODE)
+#else
 	inline void SSD2805WriteData(BYTE data)
 	{
+		SSD_PERF(bytesWritten, SSD_BUS_BYTES);
+		SSD2805TxWait();
 		DisplayEnable();
 		DisplaySetData();
 		DeviceWrite((BYTE)data);
 		DisplayDisable();
 	}
-	#endif
-#elif defined USE_SSD2805_VIDEO_MODE
-	inline void SSD2805WriteData(BYTE data)
-	{
-		//spi functions
-	}
+#endif
+
+#if defined (USE_GFX_SPI) && defined (SSD_SPI_DMA_CHANNEL)
+//DMA channel registers selected by SSD_SPI_DMA_CHANNEL, e.g. SSD_DMA_REG(CON) -> DCH0CON
+#define __SSD_DMA_REG(ch, reg)	DCH##ch##reg
+#define _SSD_DMA_REG(ch, reg)	__SSD_DMA_REG(ch, reg)
+#define SSD_DMA_REG(reg)		_SSD_DMA_REG(SSD_SPI_DMA_CHANNEL, reg)
+
+/************************************************************************
+* Function: static void SSD2805SPIWriteDMA(const BYTE *buf, WORD len)
+*
+* Overview: moves 'len' bytes to the SPI transmit buffer by DMA, one
+*			byte per SPI TX event. Returns when the last byte has been
+*			shifted out.
+*
+* Input: source buffer (RAM or flash) and number of bytes
+*
+* Output: none
+*
+* Note: chip select should be enabled and SDC set for data
+*
+************************************************************************/
+static void SSD2805SPIWriteDMA(const BYTE *buf, WORD len)
+{
+	DMACONbits.ON = 1;
+
+	SSD_DMA_REG(CON) = 0;
+	SSD_DMA_REG(ECON) = 0;
+	SSD_DMA_REG(ECONbits).CHSIRQ = SSD_SPI_TX_IRQ;	//start a cell transfer on each SPI TX event
+	SSD_DMA_REG(ECONbits).SIRQEN = 1;
+	SSD_DMA_REG(SSA) = KVA_TO_PA(buf);
+	SSD_DMA_REG(DSA) = KVA_TO_PA((void*)&SSD_SPIBUF);
+	SSD_DMA_REG(SSIZ) = len;
+	SSD_DMA_REG(DSIZ) = 1;
+	SSD_DMA_REG(CSIZ) = 1;
+	SSD_DMA_REG(INT) = 0;						//clear all flags, no interrupt
+	SSD_DMA_REG(CONbits).CHEN = 1;
+	SSD_DMA_REG(ECONbits).CFORCE = 1;			//first byte, TX buffer is already empty
+
+	while(!SSD_DMA_REG(INTbits).CHBCIF);		//block transfer complete
+	while(SSD_SPISTATbits.SPIBUSY);				//last byte shifted out
+
+	SSD_DMA_REG(CONbits).CHEN = 0;
+	SSD_SPIBUF;									//received bytes are don't care
+	SSD_SPISTATbits.SPIROV = 0;
+}
 #endif
 
 
@@ -124,7 +357,8 @@ inline void SSD2805WriteCmd(BYTE cmd)
 * Function: void SSD2805WriteReg(BYTE reg, WORD data)                                           
 *                                                                       
 * Overview: this function writes a 16-bit word to the local register 
-*			of SSD2805 specified by 'data'
+*			of SSD2805 specified by 'data'. The write is skipped if
+*			the shadow copy shows the register already holds 'data'.
 *                                                                       
 * Input: 'data' to be written and register address 'reg'
 *                                                                       
@@ -133,6 +367,26 @@ inline void SSD2805WriteCmd(BYTE cmd)
 ************************************************************************/
 void SSD2805WriteReg(BYTE reg, WORD data)
 {
+	BYTE i = SSD2805ShadowIndex(reg);
+
+	if(i != 0xFF)
+	{
+		if((_regShadowValid & (1 << i)) && (_regShadow[i] == data))
+		{
+			SSD_PERF(regWritesElided, 1);
+			return;
+		}
+		_regShadow[i] = data;
+		_regShadowValid |= (1 << i);
+	}
+	SSD_PERF(regWrites, 1);
+#ifdef USE_SSD2805_TRACE
+	if(reg == 0xbc)
+		_traceTdc.w[0] = data;
+	else if(reg == 0xbd)
+		_traceTdc.w[1] = data;
+	SSD_TRACE_FULL(SSD2805_TRACE_REG, reg, data);
+#endif
 	SSD2805WriteCmd(reg);
 #if defined (USE_16BIT_PMP)
 	SSD2805WriteData(data);
@@ -157,9 +411,13 @@ WORD SSD2805ReadReg(BYTE reg)
 {
 	WORD_VAL temp;
 
+	SSD2805TxWait();
 	DisplayEnable();
 	DisplaySetCommand();
 	DeviceWrite(reg);
+#if defined (USE_GFX_SPI)
+	DeviceWrite(0xFA);		//send read command, required for SPI only
+#endif
 //	SSD2805WriteCmd(0xFA);	//send read command, no need for MCU IF
 	DisplaySetData();		//set data for read
 #if defined (USE_16BIT_PMP)
@@ -171,387 +429,3404 @@ WORD SSD2805ReadReg(BYTE reg)
 #endif
 	DisplayDisable();
 
+#if defined (USE_GFX_SPI)
+	SSD_PERF(bytesWritten, 2);
+#else
+	SSD_PERF(bytesWritten, 1);
+#endif
+	SSD_PERF(bytesRead, 2);
+	SSD_TRACE_FULL(SSD2805_TRACE_READ, reg, temp.Val);
 	return (temp.Val);
 }
- 
 
-BYTE SSD2805ReadDCS(BYTE reg)
+/*********************************************************************
+* Function: static WORD SSD2805ShadowValue(BYTE reg, WORD value)
+*
+* Overview: returns the shadow of 'reg', or 'value' if there is none
+*
+********************************************************************/
+static WORD SSD2805ShadowValue(BYTE reg, WORD value)
 {
-	WORD_VAL temp;
-	WORD byteCount;
-	BYTE value;
+	BYTE i = SSD2805ShadowIndex(reg);
+
+	if((i != 0xFF) && (_regShadowValid & (1 << i)))
+		return (_regShadow[i]);
+	return (value);
+}
 
-	temp.Val = SSD2805ReadReg(0xb7); //store present value of 0xB7
-	SSD2805WriteReg(0xb7, temp.Val|0x00c0);
+/*********************************************************************
+* Function: static void SSD2805PlanTransfer(DWORD bytes, BYTE unit)
+*
+* Overview: sets up SSD2805 for the next transfer of 'bytes' bytes to
+*			the panel. TDC is written as a whole, 0xBD included, so no
+*			transfer depends on what a larger one before it left. The
+*			packet size threshold 0xBE is only raised when the transfer
+*			does not fit the threshold in effect:
+*			- unit 0, a DCS packet that must not be split: raised to
+*			  'bytes'
+*			- unit n, pixel data of n bytes per pixel: raised to the
+*			  largest multiple of n up to SSD2805_PACKET_SIZE, so that
+*			  long writes go in maximal long packets that end on a
+*			  pixel boundary
+*			Short writes therefore leave 0xBE alone. All writes go
+*			through the register shadow and cost no bus cycles when
+*			nothing changes. After reset or a shadow loss every
+*			register is written again.
+*
+********************************************************************/
+static void SSD2805PlanTransfer(DWORD bytes, BYTE unit)
+{
+	DWORD_VAL tdc;
+	WORD threshold = SSD2805ShadowValue(0xbe, 0);		//0 if not known
 
+	tdc.Val = bytes;
+	SSD2805WriteReg(0xbc, tdc.w[0]);					//TDC[15:0]
+	SSD2805WriteReg(0xbd, tdc.w[1]);					//TDC[31:16]
 
-	SSD2805WriteReg(0xbc, 0x0000);			//define TDC size
-	SSD2805WriteReg(0xbd, 0x0000);			//this is required after ClearDevice(), since 0xbd set to 0x400 in ClearDevice()
-	SSD2805WriteCmd(reg);					//register to read from MIPI slave	
-	
-	//SSD2805WriteDCS(reg, 0, NULL);		//issue a DCS read command e.g. 0x0c to read pixel format
+	if(bytes <= threshold)
+		return;
+	if(unit == 0)
+		SSD2805WriteReg(0xbe, (WORD)bytes);
+	else
+		SSD2805WriteReg(0xbe, SSD2805_PACKET_SIZE - (SSD2805_PACKET_SIZE % unit));
+}
 
-	while(!SSD2805ReadReg(0xc6)&0x01);
+// 0xB7 configuration bits selected per packet
+#define SSD_CFG_HS				0x0001		// HS transmission, LP if clear
+#define SSD_CFG_DCS				0x0040		// DCS packet, generic if clear
+#define SSD_CFG_LPE				0x0400		// long packet even for short payloads
+#define SSD_CFG_PACKET			(SSD_CFG_HS | SSD_CFG_DCS | SSD_CFG_LPE)
 
-	byteCount = SSD2805ReadReg(0xc2);
+/*********************************************************************
+* Function: static WORD SSD2805GetConfig(void)
+*
+* Overview: returns 0xB7, from the register shadow when it is valid
+*
+********************************************************************/
+static WORD SSD2805GetConfig(void)
+{
+	BYTE i = SSD2805ShadowIndex(0xb7);
+
+	if(_regShadowValid & (1 << i))
+		return (_regShadow[i]);
+	return (SSD2805ReadReg(0xb7));
+}
+
+/************************************************************************
+* Function: static void SSD2805SendPacket(BYTE cmd, const BYTE *buf, WORD len)
+*
+* Overview: sets TDC to 'len' and sends 'cmd' with 'len' parameter
+*			bytes in a single chip select window, see
+*			SSD2805PlanTransfer()
+*
+* Note: with USE_SSD2805_PMP_IRQ a long block is sent from the PMP
+*		interrupt and 'buf' must stay valid until IsDeviceBusy() is 0
+*
+************************************************************************/
+static void SSD2805SendPacket(BYTE cmd, const BYTE *buf, WORD len)
+{
+	SSD2805PlanTransfer(len, 0);
+
+	SSD_TRACE(SSD2805_TRACE_DCS, cmd, len);
+	SSD_PERF(dcsCommands, 1);
+	SSD_PERF(bytesWritten, 1 + len);
+	SSD2805TxWait();
 	DisplayEnable();
 	DisplaySetCommand();
-	DeviceWrite(0xD7);
-	DisplaySetData();		//set data for read
-	while(byteCount--)
+	DeviceWrite(cmd);
+	DisplaySetData();
+#if defined (USE_GFX_SPI) && defined (SSD_SPI_DMA_CHANNEL)
+	if(len)
+		SSD2805SPIWriteDMA(buf, len);
+#elif defined (USE_SSD2805_PMP_IRQ) && !defined (USE_16BIT_PMP)
+	if(len >= SSD2805_PMP_IRQ_MIN_CYCLES)
+	{
+		SSD2805PMPTxStart(buf, 0, len);		//chip select released by the interrupt
+		return;
+	}
+	while(len--)
+		DeviceWrite(*buf++);
+#elif defined (USE_16BIT_PMP)
+	while(len > 1)
 	{
-		value = DeviceRead();
+		DeviceWrite(((WORD)buf[1]<<8) | buf[0]);	//lower byte sent first on MIPI link
+		buf += 2;
+		len -= 2;
 	}
+	if(len)
+		DeviceWrite(buf[0]);
+#else
+	while(len--)
+		DeviceWrite(*buf++);
+#endif
 	DisplayDisable();
+}
 
-	SSD2805WriteReg(0xb7, temp.Val);
+/************************************************************************
+* Function: static void SSD2805SendPacketEx(BYTE cmd, const BYTE *buf,
+*						WORD len, WORD config)
+*
+* Overview: sends a packet with the 0xB7 packet bits set to 'config',
+*			the previous bits are restored after the packet
+*
+************************************************************************/
+static void SSD2805SendPacketEx(BYTE cmd, const BYTE *buf, WORD len, WORD config)
+{
+	WORD saved = SSD2805GetConfig();
 
-	return (value);
+	config |= saved & ~SSD_CFG_PACKET;
+	if(config == saved)
+	{
+		SSD2805SendPacket(cmd, buf, len);
+		return;
+	}
+	SSD2805WriteReg(0xb7, config);
+	SSD2805SendPacket(cmd, buf, len);
+	SSD2805WriteReg(0xb7, saved);			//waits for an interrupt transfer
 }
 
-/*********************************************************************
-* Function:  SetAddress(WORD x, WORD y)
-*
-* Overview: Writes Column and Page Addresses as position (x,y)
+/************************************************************************
+* Function: void SSD2805WriteDCS(BYTE cmd, const BYTE *buf, WORD len)
 *
-* PreCondition: none
+* Overview: sends DCS command 'cmd' with 'len' parameter bytes
 *
-* Input: WORD x, WORD y
+************************************************************************/
+void SSD2805WriteDCS(BYTE cmd, const BYTE *buf, WORD len)
+{
+	SSD2805SendPacket(cmd, buf, len);
+}
+
+/************************************************************************
+* Function: void SSD2805WriteDCSEx(BYTE cmd, const BYTE *buf, WORD len, BYTE flags)
 *
-* Output: none
+* Overview: sends a DCS packet in LP or HS, short or long
 *
-* Side Effects: none
-* Remarks:  From end-of-column (EC) and end-of-page (EP) limits we know
-*			it is possible to scroll either horizontally or vertically
-*			but not both.
-********************************************************************/
-
-inline void SetAddress(WORD x, WORD y)
+************************************************************************/
+void SSD2805WriteDCSEx(BYTE cmd, const BYTE *buf, WORD len, BYTE flags)
 {
-	SSD2805WriteReg(0xbc, 0x0004);	//Set packet size TDC[15:0]
-	SSD2805WriteReg(0xbd, 0x0000);	//Set packet size TDC[31:16]
+	WORD config = SSD_CFG_DCS;
 
-	#if defined (USE_16BIT_PMP)
-                WORD x1 = GetMaxX(), y1=GetMaxY();
+	if(!(flags & SSD2805_PACKET_LP))
+		config |= SSD_CFG_HS;
+	if(flags & SSD2805_PACKET_LONG)
+		config |= SSD_CFG_LPE;
+	SSD2805SendPacketEx(cmd, buf, len, config);
+}
 
-		DisplayEnable();
-		DisplaySetCommand();
-		DeviceWrite(0x2A);
-		DisplaySetData();
-		DeviceWrite(Swap(x));	//SC[15:0]
-		DeviceWrite(Swap(x1));	//EC[15:0]	
-		DisplaySetCommand();
-		DeviceWrite(0x2B);
-		DisplaySetData();
-		DeviceWrite(Swap(y));	//SP[15:0]
-		DeviceWrite(Swap(y1));	//EP[15:0]
-		DisplayDisable();	
+/************************************************************************
+* Function: void SSD2805WriteGeneric(const BYTE *buf, WORD len, BYTE flags)
+*
+* Overview: sends a generic packet, the payload goes through the
+*			packet drop register 0xBF
+*
+************************************************************************/
+void SSD2805WriteGeneric(const BYTE *buf, WORD len, BYTE flags)
+{
+	WORD config = 0;
 
-	//#elif defined (USE_8BIT_PMP)
-	#else
-		SSD2805WriteCmd(0x2A);	//DCS command to MIPI slave, Column address set
-		SSD2805WriteData((BYTE)(x>>8));				//SC[15:8]
-		SSD2805WriteData((BYTE)x);				//SC[7:0]
-		SSD2805WriteData((BYTE)((GetMaxX())>>8));	//EC[15:8]
-		SSD2805WriteData((BYTE)(GetMaxX()));		//EC[7:0]
-		SSD2805WriteCmd(0x2B);	//DCS command to MIPI slave, Page address set
-		SSD2805WriteData((BYTE)(y>>8));				//SP[15:8]
-		SSD2805WriteData((BYTE)y);					//SP[7:0]
-		SSD2805WriteData((BYTE)((GetMaxY())>>8));	//EP[15:8]
-		SSD2805WriteData((BYTE)GetMaxY());			//EP[7:0]
+	if(!(flags & SSD2805_PACKET_LP))
+		config |= SSD_CFG_HS;
+	if(flags & SSD2805_PACKET_LONG)
+		config |= SSD_CFG_LPE;
+	SSD2805SendPacketEx(0xbf, buf, len, config);
+}
 
-	#endif
+/************************************************************************
+* Function: void SSD2805WriteBlock(BYTE cmd, const BYTE *buf, WORD len)
+*
+* Overview: same as SSD2805WriteDCS()
+*
+************************************************************************/
+void SSD2805WriteBlock(BYTE cmd, const BYTE *buf, WORD len)
+{
+	SSD2805SendPacket(cmd, buf, len);
 }
 
+// 0xC6 interrupt status bits used by the read engine
+#define SSD_ISR_RDR				0x0001		// read data ready
+#define SSD_ISR_ARR				0x0002		// acknowledge and error report received
+#define SSD_ISR_LPTO			0x0008		// LP receive timeout, the panel did not answer
+
+static SSD2805_READ_INFO	_readInfo;		// result of the last DCS read
 
 /*********************************************************************
-* Function:  void ResetDevice()
-*
-* PreCondition: none
-*
-* Input: none
+* Function: static BYTE SSD2805ReadAttempt(BYTE cmd, BYTE *pBuf, WORD len,
+*						TIME_DEADLINE deadline)
 *
-* Output: none
-*
-* Side Effects: none
+* Overview: one DCS read request. Polls 0xC6 until data is ready, an
+*			error report arrives, the panel times out or 'deadline'
+*			passes. Returned data beyond 'len' is read and dropped so
+*			the read buffer starts empty next time.
 *
-* Overview: resets SSD2805, initializes PMP/SPI interface
+* Output: SSD2805_READ_OK or an error code, _readInfo is filled in
 *
-* Note: There are two operating clock speed before and after PLL
-*		locked in SSD2805. External oscillator is 20MHz. After
-*		PLL, the operating frequency can be as high as 500MHz.
-*		
 ********************************************************************/
-#ifdef USE_SSD2805_CMD_MODE
-void ResetDevice(void)
+static BYTE SSD2805ReadAttempt(BYTE cmd, BYTE *pBuf, WORD len, TIME_DEADLINE deadline)
 {
-    SSD_PowerOn();
-    SSD_PowerConfig();			// VDDIO switch for SSD2805
+	WORD status;
+	WORD byteCount, i;
+#if defined (USE_16BIT_PMP)
+	WORD data = 0;
+#endif
+#ifdef USE_SSD2805_PERF_COUNTERS
+	DWORD start;
+#endif
 
-    DisplayCmdDataConfig();     // enable RS line
-    DisplayDisable();
-    DisplayConfig();			// CSX# as chip select, driven high on start-up
- 
-    DisplayBacklightOn();       // initially set the backlight to on
-    DisplayBacklightConfig();   // set the backlight control pin
-   
-    /////////////////////////////////////////////////////////////////////
-    // Initialize PMP interface for 8080
-    /////////////////////////////////////////////////////////////////////
-	#if defined (USE_GFX_PMP)
-	    // PMP setup
-	    PMMODE = 0;
-	    PMCON = 0;
-	    PMMODEbits.MODE = 2;                //Intel 80 master interface
-            PMMODEbits.WAITB = 0;		//Before PLL is locked, SSD2805 running @20MHz (dictated by external oscillator)
-            PMMODEbits.WAITM = 15;		//A min. WR# cycle of 3T is required with T=(1/20)*1000ns, result: WR# > 150ns.
-            PMMODEbits.WAITE = 0;		//Thus it is not advised to run too fast for WR# strobe before PLL is locked.
-						//WAITB<1:0>, WAITM<3:0> & WAITE<1:0> are parameters for data setup time, WR#/RD# strobe 
-						//time, and data hold time. 
-						//Dump screen from a logic analyzer shows a WR# low pulse time measured at 
-						//200ns at C32 full optimization for speed. It is well within the limit 150ns.
-	    #if defined(USE_16BIT_PMP)
-	    PMMODEbits.MODE16 = 1;              // 16 bit mode
-	    #elif defined(USE_8BIT_PMP)
-	    PMMODEbits.MODE16 = 0;              // 8 bit mode
-	    #endif
-  
-    	PMCONbits.PTRDEN = 1;               // enable RD line
-    	PMCONbits.PTWREN = 1;               // enable WR line			
-    	PMCONbits.PMPEN = 1;                // enable PMP	
+	SSD2805WriteReg(0xc1, len);				//maximum return packet size
+	SSD2805WriteDCS(cmd, NULL, 0);			//register to read from MIPI slave
+
+#ifdef USE_SSD2805_PERF_COUNTERS
+	start = TimeGetTicks();
+#endif
+	do
+	{
+		status = SSD2805ReadReg(0xc6);
+		if(status == 0xFFFF)				//floating bus, not a status
+			status = 0;
+	} while(!(status & (SSD_ISR_RDR | SSD_ISR_ARR | SSD_ISR_LPTO)) && !TimeDeadlineExpired(deadline));
+	SSD_PERF(statusWaitTicks, TimeGetTicks() - start);
+
+	_readInfo.interruptStatus = status;
+	_readInfo.bytes = 0;
+	if(status & SSD_ISR_ARR)
+		_readInfo.errorReport = SSD2805ReadReg(0xc3);	//DSI acknowledge and error report
+
+	if(!(status & SSD_ISR_RDR))
+	{
+		_readInfo.errorStatus = SSD2805ReadReg(0xc7);
+		if(status & SSD_ISR_ARR)
+			return (SSD2805_READ_ERROR_REPORT);
+		return (SSD2805_READ_TIMEOUT);
+	}
+
+	byteCount = SSD2805ReadReg(0xc2);
+	SSD_PERF(bytesWritten, 1);
+	SSD_PERF(bytesRead, byteCount);
+	DisplayEnable();
+	DisplaySetCommand();
+	DeviceWrite(0xD7);
+	DisplaySetData();		//set data for read
+	for(i=0; i<byteCount; i++)
+	{
+	#if defined (USE_16BIT_PMP)
+		if(!(i & 1))
+			data = DeviceRead();			//two bytes per cycle, lower byte first
+		if(i < len)
+			pBuf[i] = (i & 1)? (BYTE)(data >> 8) : (BYTE)data;
+	#else
+		if(i < len)
+			pBuf[i] = DeviceRead();
+		else
+			DeviceRead();
 	#endif
-		
-	SSD_ResetDisable();		// Keep RESET pin high for SSD2805 & LH154Q01  >250ms (mainly for LH154Q01) 		
-    SSD_ResetConfig();			// set RESET pin an output
-	DelayMs(300);			// delay for 300ms
-    SSD_ResetEnable();                  // Keep RESET pin low for SSD2805 & LH154Q01 >5ms
-	DelayMs(10);
-	SSD_ResetDisable();		// now release RESET from low and keep RESET high for normal operation
-	DelayMs(1);
-	LH_PowerOn();			// turn VDDIO of LH154Q01 on
-	LH_PowerConfig();
-
-	DelayMs(10);			// wait 10ms to start MIPI command
-
-		//Step 1: Set PLL
-		SSD2805WriteReg(0xba, 0x000f);	//PLL 	= clock*MUL/(PDIV*DIV) 
-						//		= clock*(BAh[7:0]+1)/((BAh[15:12]+1)*(BAh[11:8]+1))
-						//		= 20*(0x0f+1)/1*1 = 20*16 = 320MHz
-						//Remark: 350MHz >= fvco >= 225MHz for SSD2805 since the max. speed per lane is 350Mbps
-		SSD2805WriteReg(0xb9, 0x0001);	//enable PLL
-
-		//	while((SSD2805ReadReg(0xc6)&0x0080)!=0x0080)	//infinite loop to wait for PLL to lock
-		//		;
-
-		DelayMs(2);		//simply wait for 2 ms for PLL lock, more stable as SSD2805ReadReg(arg) doesn't work at full compiler optimzation
-		//Step 2: Now it is safe to set PMP at max. speed
-		PMCONbits.PMPEN = 0;				
-		PMMODEbits.WAITM = 0;				//after PLL locked, it is possible to set PMP at max. speed
-		PMCONbits.PMPEN = 1;
-		
-		//Step 3: set clock control register for SYS_CLK & LP clock speed
-		//SYS_CLK = TX_CLK/(BBh[7:6]+1), TX_CLK = external oscillator clock speed
-		//In this case, SYS_CLK = 20MHz/(1+1)=10MHz. Measure SYS_CLK pin to verify it.
-		//LP clock = PLL/(8*(BBh[5:0]+1)) = 320/(8*(4+1)) = 8MHz, conform to AUO panel's spec, default LP = 8Mbps
-		//S6D04D2 is the controller of AUO 1.54" panel.
-		SSD2805WriteReg(0xBB, 0x0044);
-		SSD2805WriteReg(0xD6, 0x0100);	//output sys_clk for debug. Now check sys_clk pin for 10MHz signal
+	}
+	DisplayDisable();
 
-		//Step 4: Set MIPI packet format
-		SSD2805WriteReg(0xB7, 0x0243);	//EOT packet enable, write operation, it is a DCS packet
-										//HS clock is disabled, video mode disabled, in HS mode to send data
+	_readInfo.bytes = (byteCount < len)? byteCount : len;
+	return ((byteCount)? SSD2805_READ_OK : SSD2805_READ_NO_DATA);
+}
+
+/*********************************************************************
+* Function: BYTE SSD2805ReadDCSEx(BYTE cmd, BYTE *pBuf, WORD *pLen)
+*
+* Overview: DCS read with bounded status polling and retries. All
+*			attempts share SSD2805_READ_TIMEOUT_MS.
+*
+* Input: cmd - DCS command, pBuf - data, *pLen - size of pBuf
+*
+* Output: SSD2805_READ_OK or an error code, *pLen - bytes read
+*
+********************************************************************/
+BYTE SSD2805ReadDCSEx(BYTE cmd, BYTE *pBuf, WORD *pLen)
+{
+	WORD config;
+	TIME_DEADLINE deadline;
+	BYTE result;
 
-		//Step 5: set Virtual Channel (VC) to use
-		SSD2805WriteReg(0xB8, 0x0000);
+	config = SSD2805ReadReg(0xb7);			//store present value of 0xB7
+	SSD2805WriteReg(0xb7, config|0x00c0);	//read enable, DCS packet
 
+	_readInfo.attempts = 0;
+	_readInfo.errorReport = 0;
+	_readInfo.errorStatus = 0;
+	deadline = TimeDeadlineMs(SSD2805_READ_TIMEOUT_MS);
+	for(;;)
+	{
+		_readInfo.attempts++;
+		result = SSD2805ReadAttempt(cmd, pBuf, *pLen, deadline);
+		if((result == SSD2805_READ_OK) || (_readInfo.attempts > SSD2805_READ_RETRIES) || TimeDeadlineExpired(deadline))
+			break;
+		SSD_PERF(readRetries, 1);
+	}
 
-		//Step 6: Now write DCS command to AUO panel for system power-on upon reset
-		SSD2805WriteReg(0xbc, 0x0000);			//define TDC size
-		SSD2805WriteReg(0xbd, 0x0000);
-		SSD2805WriteCmd(0x11);				//DCS sleep-out command
+	SSD2805WriteReg(0xb7, config);
 
-                DelayMs(100);					//wait for AUO/LG  panel after sleep out
+	if(result != SSD2805_READ_OK)
+		SSD_PERF(readFailures, 1);
+	_readInfo.result = result;
+	*pLen = _readInfo.bytes;
+	SSD_TRACE(SSD2805_TRACE_DCS_READ, cmd, (_readInfo.bytes)? pBuf[_readInfo.bytes - 1] : 0);
+	return (result);
+}
 
-		//Step 7: Now configuration parameters sent to AUO
-		SSD2805WriteReg(0xbc, 0x0001);			//define TDC size to be 1
-		SSD2805WriteReg(0xbd, 0x0000);
-		SSD2805WriteCmd(0x3a);				//DCS command sent to register @ 0x3a, set 16-bit pixel format
-		SSD2805WriteData(0x05);				//Set 0x3a to 0x05 (16-bit color)
+/*********************************************************************
+* Function: BYTE SSD2805ReadDCS(BYTE reg)
+*
+* Overview: reads one byte with SSD2805ReadDCSEx()
+*
+* Output: byte read, 0 if the read failed
+*
+********************************************************************/
+BYTE SSD2805ReadDCS(BYTE reg)
+{
+	BYTE value = 0;
+	WORD len = 1;
 
-		SetColor(0);					//debug here for different color on POR
-		ClearDevice();
+	SSD2805ReadDCSEx(reg, &value, &len);
+	return (value);
+}
 
-		SSD2805WriteReg(0xbc, 0x0000);			//define TDC size
-		SSD2805WriteReg(0xbd, 0x0000);			//this is required after ClearDevice(), since 0xbd set to 0x400 in ClearDevice()
-		SSD2805WriteCmd(0x29);				//display ON DCS command to AUO panel
+/*********************************************************************
+* Function: void SSD2805GetReadInfo(SSD2805_READ_INFO *pInfo)
+*
+* Overview: copies the status of the last DCS read
+*
+********************************************************************/
+void SSD2805GetReadInfo(SSD2805_READ_INFO *pInfo)
+{
+	*pInfo = _readInfo;
 }
-#endif //USE_SSD2805_CMD_MODE
 
-#ifdef USE_TRANSPARENT_COLOR
 /*********************************************************************
-* Function:  void TransparentColorEnable(GFX_COLOR color)
+* Function:  SSD2805SetWindow(WORD left, WORD top, WORD right, WORD bottom)
 *
-* Overview: Sets current transparent color.
+* Overview: Writes Column and Page Addresses for a window, subsequent
+*			memory write (0x2C) fills the window row by row
 *
 * PreCondition: none
 *
-* Input: color - Color value chosen.
+* Input: window borders, inclusive
 *
 * Output: none
 *
 * Side Effects: none
 *
 ********************************************************************/
-void TransparentColorEnable(GFX_COLOR color)
+void SSD2805SetWindow(WORD left, WORD top, WORD right, WORD bottom)
 {
-    _colorTransparent = color;    
-    _colorTransparentEnable = TRANSPARENT_COLOR_ENABLE;
+	SSD_PERF(windows, 1);
+	SSD2805PlanTransfer(4, 0);		//4 parameter bytes each for 0x2A and 0x2B
 
-}
-#endif
+	#if defined (USE_16BIT_PMP)
+		SSD_TRACE(SSD2805_TRACE_DCS, 0x2A, 4);
+		SSD_TRACE(SSD2805_TRACE_DCS, 0x2B, 4);
+		SSD_PERF(dcsCommands, 2);
+		SSD_PERF(bytesWritten, 2 + 8);
+		SSD2805TxWait();
+		DisplayEnable();
+		DisplaySetCommand();
+		DeviceWrite(0x2A);
+		DisplaySetData();
+		DeviceWrite(Swap(left));	//SC[15:0]
+		DeviceWrite(Swap(right));	//EC[15:0]	
+		DisplaySetCommand();
+		DeviceWrite(0x2B);
+		DisplaySetData();
+		DeviceWrite(Swap(top));		//SP[15:0]
+		DeviceWrite(Swap(bottom));	//EP[15:0]
+		DisplayDisable();	
+
+	//#elif defined (USE_8BIT_PMP)
+	#else
+		SSD2805WriteCmd(0x2A);	//DCS command to MIPI slave, Column address set
+		SSD2805WriteData((BYTE)(left>>8));			//SC[15:8]
+		SSD2805WriteData((BYTE)left);				//SC[7:0]
+		SSD2805WriteData((BYTE)(right>>8));			//EC[15:8]
+		SSD2805WriteData((BYTE)right);				//EC[7:0]
+		SSD2805WriteCmd(0x2B);	//DCS command to MIPI slave, Page address set
+		SSD2805WriteData((BYTE)(top>>8));			//SP[15:8]
+		SSD2805WriteData((BYTE)top);				//SP[7:0]
+		SSD2805WriteData((BYTE)(bottom>>8));		//EP[15:8]
+		SSD2805WriteData((BYTE)bottom);				//EP[7:0]
 
+	#endif
+}
 
 /*********************************************************************
-* Function: void PutPixel(SHORT x, SHORT y)
+* Function:  SetAddress(WORD x, WORD y)
 *
-* Overview: Put pixel with the given x,y coordinate position.
+* Overview: Writes Column and Page Addresses as position (x,y)
 *
 * PreCondition: none
 *
-* Input: x - x position of the pixel.
-*		 y - y position of the pixel.
+* Input: WORD x, WORD y
 *
 * Output: none
 *
 * Side Effects: none
-*
+* Remarks:  From end-of-column (EC) and end-of-page (EP) limits we know
+*			it is possible to scroll either horizontally or vertically
+*			but not both.
 ********************************************************************/
+
+inline void SetAddress(WORD x, WORD y)
+{
+	SSD2805SetWindow(x, y, GetMaxX(), GetMaxY());
+}
+
 #ifdef USE_SSD2805_CMD_MODE
-void PutPixel(SHORT x, SHORT y)
+static BYTE		_pixelFormat = SSD2805_PIXEL_FORMAT;	// DCS 0x3A value in use
+static BYTE		_pixelBytes = (SSD2805_PIXEL_FORMAT == SSD2805_PIXEL_FORMAT_16)? 2 : 3;
+
+#define SSD_RGB888_TO_565(c)	((WORD)((((c) >> 8) & 0xF800) | (((c) >> 5) & 0x07E0) | (((c) >> 3) & 0x001F)))
+
+// 0x00RRGGBB to the 3-byte pixel sent low byte first, and back
+#if defined (SSD2805_PIXEL_ORDER_BGR)
+#define SSD_RGB888_TO_BUS(c)	(c)
+#else
+#define SSD_RGB888_TO_BUS(c)	((((c) >> 16) & 0x0000FF) | ((c) & 0x00FF00) | (((c) << 16) & 0xFF0000))
+#endif
+
+/*********************************************************************
+* Function: static DWORD SSD2805Rgb565To888(WORD color)
+*
+* Overview: expands RGB565 to 0x00RRGGBB, low bits repeat the high bits
+*
+********************************************************************/
+static inline DWORD SSD2805Rgb565To888(WORD color)
 {
-	SetAddress(x,y);
+	DWORD r = (color >> 11) & 0x1F;
+	DWORD g = (color >> 5) & 0x3F;
+	DWORD b = color & 0x1F;
 
-	SSD2805WriteReg(0xbc, 0x0002);	//write to registers of SSD2805 at 0xbc, 0xbd
-	SSD2805WriteReg(0xbd, 0x0000);	//to set the size of block write, this time,
-									//a single pixel of 2 bytes required for 16-bit color
-	DisplayEnable();										
-	DisplaySetCommand(); DeviceWrite(0x2c);		
-								
-	DisplaySetData();
-		#if defined (USE_16BIT_PMP)
-			DeviceWrite(_color);
-		//#elif defined (USE_8BIT_PMP)
-		#else	
-			DeviceWrite(_color);
-			DeviceWrite(_color>>8);
-		#endif
+	return ((((r << 3) | (r >> 2)) << 16) | (((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2)));
+}
 
-	DisplayDisable();
+/*********************************************************************
+* Function: static DWORD SSD2805BusColor(GFX_COLOR color)
+*
+* Overview: converts a color to the panel pixel format, the result is
+*			sent low byte first, 2 or 3 bytes
+*
+********************************************************************/
+static inline DWORD SSD2805BusColor(GFX_COLOR color)
+{
+#if (COLOR_DEPTH == 24)
+	return ((_pixelBytes == 2)? SSD_RGB888_TO_565(color) : SSD_RGB888_TO_BUS(color));
+#else
+	return ((_pixelBytes == 2)? color : SSD_RGB888_TO_BUS(SSD2805Rgb565To888(color)));
+#endif
 }
-#endif	//USE_SSD2805_CMD_MODE
 
 /*********************************************************************
-* Function: WORD GetPixel(SHORT x, SHORT y)
+* Function: static GFX_COLOR SSD2805FromBusColor(DWORD bus)
 *
-* PreCondition: none
+* Overview: converts a pixel read from the panel back to GFX_COLOR
 *
-* Input: pixel position
+********************************************************************/
+static inline GFX_COLOR SSD2805FromBusColor(DWORD bus)
+{
+#if (COLOR_DEPTH == 24)
+	return ((_pixelBytes == 2)? SSD2805Rgb565To888((WORD)bus) : SSD_RGB888_TO_BUS(bus & 0x00FFFFFF));
+#else
+	return ((_pixelBytes == 2)? (WORD)bus : SSD_RGB888_TO_565(SSD_RGB888_TO_BUS(bus)));
+#endif
+}
+
+/*********************************************************************
+* Function: static void SSD2805WritePixels(const GFX_COLOR *pData, GFX_COLOR color, DWORD count)
 *
-* Output: pixel color
+* Overview: writes 'count' pixels from pData, or 'color' repeated if
+*			pData is NULL, in the panel pixel format. 3-byte pixels
+*			are packed without padding, with 16-bit PMP two pixels
+*			take three cycles. Chip select must be enabled and SDC
+*			set for data, chip select is released when done.
 *
-* Side Effects: none
+* Note: with USE_SSD2805_PMP_IRQ 2-byte pixels that need no conversion
+*		are written from the PMP interrupt, the function returns
+*		before they are sent
+*
+********************************************************************/
+static void SSD2805WritePixels(const GFX_COLOR *pData, GFX_COLOR color, DWORD count)
+{
+	DWORD bus = SSD2805BusColor(color);
+#if defined (USE_16BIT_PMP)
+	DWORD next;
+#endif
+
+#if defined (USE_GFX_PMP) && defined (USE_SSD2805_PMP_IRQ)
+	if((_pixelBytes == 2) && ((pData == NULL) || (COLOR_DEPTH == 16)) && ((count*2)/SSD_BUS_BYTES >= SSD2805_PMP_IRQ_MIN_CYCLES))
+	{
+		SSD2805PMPTxStart(pData, (WORD)bus, (count*2)/SSD_BUS_BYTES);	//pixel data in RAM is already low byte first
+		return;
+	}
+#endif
+	if(_pixelBytes == 2)
+	{
+		while(count--)
+		{
+			if(pData)
+				bus = SSD2805BusColor(*pData++);
+		#if defined (USE_16BIT_PMP)
+			DeviceWrite((WORD)bus);
+		#else
+			DeviceWrite((BYTE)bus);
+			DeviceWrite((BYTE)(bus>>8));
+		#endif
+		}
+	}
+	else
+	{
+	#if defined (USE_16BIT_PMP)
+		next = bus;
+		while(count >= 2)
+		{
+			if(pData)
+			{
+				bus = SSD2805BusColor(pData[0]);
+				next = SSD2805BusColor(pData[1]);
+				pData += 2;
+			}
+			DeviceWrite((WORD)bus);									//bytes 0, 1 of pixel 0
+			DeviceWrite((WORD)(((bus >> 16) & 0x00FF) | (next << 8)));	//byte 2 of pixel 0, byte 0 of pixel 1
+			DeviceWrite((WORD)(next >> 8));							//bytes 1, 2 of pixel 1
+			count -= 2;
+		}
+		if(count)
+		{
+			if(pData)
+				bus = SSD2805BusColor(*pData);
+			DeviceWrite((WORD)bus);
+			DeviceWrite((WORD)((bus >> 16) & 0x00FF));				//upper byte pads the burst, see SSD_BUS_PADDED()
+		}
+	#else
+		while(count--)
+		{
+			if(pData)
+				bus = SSD2805BusColor(*pData++);
+			DeviceWrite((BYTE)bus);
+			DeviceWrite((BYTE)(bus>>8));
+			DeviceWrite((BYTE)(bus>>16));
+		}
+	#endif
+	}
+	DisplayDisable();
+}
+
+/*********************************************************************
+* Function: BYTE SSD2805SetPixelFormat(BYTE format)
+*
+* Overview: sets the panel pixel format with DCS 0x3A
 *
-* Overview: returns pixel at given position
+* Input: format - SSD2805_PIXEL_FORMAT_16, _18 or _24
 *
-* Note: Not working yet
+* Output: 1 if set, 0 if the format is not supported
 *
 ********************************************************************/
-#ifdef USE_SSD2805_CMD_MODE
-GFX_COLOR GetPixel(SHORT x, SHORT y)
+BYTE SSD2805SetPixelFormat(BYTE format)
 {
-	GFX_COLOR color;
+	if((format != SSD2805_PIXEL_FORMAT_16) && (format != SSD2805_PIXEL_FORMAT_18) && (format != SSD2805_PIXEL_FORMAT_24))
+		return (0);
 
-	SetAddress(x,y);
+	SSD2805WriteDCS(0x3a, &format, 1);		//DCS set_pixel_format
 
-	color = SSD2805ReadDCS(0x2E);
-	color = (SSD2805ReadDCS(0x2E)<<8)|color;
-	return (color);
+	_pixelFormat = format;
+	_pixelBytes = (format == SSD2805_PIXEL_FORMAT_16)? 2 : 3;
+	return (1);
 }
-#endif
 
 /*********************************************************************
-* Function: IsDeviceBusy()
+* Function: BYTE SSD2805GetPixelFormat(void)
 *
-* Overview: Returns non-zero if LCD controller is busy 
-*           (previous drawing operation is not completed).
+* Overview: returns the pixel format in use
 *
-* PreCondition: none
+********************************************************************/
+BYTE SSD2805GetPixelFormat(void)
+{
+	return (_pixelFormat);
+}
+
+static WORD		_orientation = DISP_ORIENTATION;
+
+/*********************************************************************
+* Function: BYTE SSD2805SetOrientation(WORD degrees, BYTE mirror)
 *
-* Input: none
+* Overview: sets MADCTL (DCS 0x36) for the orientation and mirroring
 *
-* Output: Busy status.
+* Input: degrees - 0, 90, 180 or 270, mirror - SSD2805_MIRROR_X/_Y
 *
-* Side Effects: none
+* Output: 1 if set, 0 if the orientation is not supported
 *
 ********************************************************************/
+BYTE SSD2805SetOrientation(WORD degrees, BYTE mirror)
+{
+	BYTE madctl;
 
-WORD IsDeviceBusy(void)
-{  
-    return (0);
+	switch(degrees)
+	{
+		case 0:		madctl = SSD2805_MADCTL_0;		break;
+		case 90:	madctl = SSD2805_MADCTL_90;		break;
+		case 180:	madctl = SSD2805_MADCTL_180;	break;
+		case 270:	madctl = SSD2805_MADCTL_270;	break;
+		default:	return (0);
+	}
+
+	// GetMaxX()/GetMaxY() cannot follow a change between portrait and landscape
+	if((DISP_HOR_RESOLUTION != DISP_VER_RESOLUTION) &&
+		(((degrees == 90) || (degrees == 270)) != ((DISP_ORIENTATION == 90) || (DISP_ORIENTATION == 270))))
+		return (0);
+
+	// screen x runs along the panel rows when rows and columns are exchanged
+	if(mirror & SSD2805_MIRROR_X)
+		madctl ^= (madctl & SSD2805_MADCTL_MV)? SSD2805_MADCTL_MY : SSD2805_MADCTL_MX;
+	if(mirror & SSD2805_MIRROR_Y)
+		madctl ^= (madctl & SSD2805_MADCTL_MV)? SSD2805_MADCTL_MX : SSD2805_MADCTL_MY;
+
+	madctl |= SSD2805_MADCTL_BASE;
+	SSD2805WriteDCS(0x36, &madctl, 1);		//DCS set_address_mode
+
+	_orientation = degrees;
+	return (1);
 }
 
 /*********************************************************************
-* Function: void ClearDevice(void)
+* Function: WORD SSD2805GetOrientation(void)
 *
-* PreCondition: none
+* Overview: returns the orientation in degrees
 *
-* Input: none
+********************************************************************/
+WORD SSD2805GetOrientation(void)
+{
+	return (_orientation);
+}
+#endif //USE_SSD2805_CMD_MODE
+
+
+#if defined (USE_GFX_PMP)
+// PMP wait states of a timing profile, see SSD2805PMPTimingCalc()
+typedef struct
+{
+	BYTE	waitB;		// data setup, WAITB+1 Tpb
+	BYTE	waitM;		// RD#/WR# strobe, WAITM+1 Tpb
+	BYTE	waitE;		// data hold, WAITE+1 Tpb for writes
+} SSD2805_PMP_TIMING;
+
+// slowest PMP timing, used until SSD2805 is out of reset
+static const SSD2805_PMP_TIMING _pmpTimingSafe = {3, 15, 3};
+static SSD2805_PMP_TIMING	_pmpTiming;			// profile in use, always a verified one
+
+/*********************************************************************
+* Function:  static void SSD2805PMPTimingCalc(SSD2805_PMP_TIMING *pTiming, DWORD clockMHz)
 *
-* Output: none
+* Overview: computes the fastest PMP profile for SSD2805 running at
+*			'clockMHz'. WR# low and WR# high must both be at least 3T
+*			with T the SSD2805 clock period (see SSD2805.h). WR# stays
+*			high through the setup and hold phases of a cycle, so these
+*			are stretched when the strobe alone is too short.
+*			PMP_DATA_SETUP_TIME and PMP_DATA_HOLD_TIME of
+*			HardwareProfile.h are kept as board minimums in all stages.
 *
-* Side Effects: none
+********************************************************************/
+static void SSD2805PMPTimingCalc(SSD2805_PMP_TIMING *pTiming, DWORD clockMHz)
+{
+	DWORD tpb = 1000000000ul/GetPeripheralClock();		// Tpb in ns
+	DWORD t3 = (3000ul + clockMHz - 1)/clockMHz;		// 3T in ns, rounded up
+	DWORD n;
+
+	n = (t3 + tpb - 1)/tpb;								// Tpb needed for WR# low
+	pTiming->waitM = (n > 16)? 15 : ((n)? (n - 1) : 0);
+
+	n = (PMP_DATA_SETUP_TIME + tpb - 1)/tpb;
+	pTiming->waitB = (n > 4)? 3 : ((n)? (n - 1) : 0);
+
+	n = (PMP_DATA_HOLD_TIME + tpb - 1)/tpb;
+	pTiming->waitE = (n > 4)? 3 : ((n)? (n - 1) : 0);
+
+	while(((DWORD)(pTiming->waitB + 1) + (pTiming->waitE + 1))*tpb < t3)
+	{
+		if(pTiming->waitE < 3)
+			pTiming->waitE++;
+		else if(pTiming->waitB < 3)
+			pTiming->waitB++;
+		else
+			break;
+	}
+}
+
+/*********************************************************************
+* Function:  static void SSD2805PMPTimingSet(const SSD2805_PMP_TIMING *pTiming)
 *
-* Overview: clears screen with current color 
+* Overview: loads a profile into PMMODE, the PMP is disabled meanwhile
 *
-* Note: none
+********************************************************************/
+static void SSD2805PMPTimingSet(const SSD2805_PMP_TIMING *pTiming)
+{
+	PMCONbits.PMPEN = 0;
+	PMMODEbits.WAITB = pTiming->waitB;
+	PMMODEbits.WAITM = pTiming->waitM;
+	PMMODEbits.WAITE = pTiming->waitE;
+	PMCONbits.PMPEN = 1;
+}
+
+/*********************************************************************
+* Function:  static BYTE SSD2805PMPTimingSwitch(DWORD clockMHz)
+*
+* Overview: switches the PMP to the profile computed for 'clockMHz'
+*			and verifies it by writing two patterns to the TDC size
+*			register (0xBC) and reading them back. On a mismatch the
+*			previous profile is restored.
+*
+* Output: 1 if the new profile is in use, 0 if the old one was kept
+*
+* Note: 0xBC is rewritten before every transfer, it is left at 0
 *
 ********************************************************************/
-void ClearDevice(void)
+static BYTE SSD2805PMPTimingSwitch(DWORD clockMHz)
 {
-	DWORD_VAL byteCount;
-	
-	DWORD pixelCount, i;
+	static const WORD pattern[] = {0x5AA5, 0xA55A};
+	SSD2805_PMP_TIMING timing;
+	BYTE i, ok = 1;
 
-	byteCount.Val = (DWORD)DISP_HOR_RESOLUTION*DISP_VER_RESOLUTION*(COLOR_DEPTH/8);
+	SSD2805PMPTimingCalc(&timing, clockMHz);
+	SSD2805PMPTimingSet(&timing);
 
-	SetAddress(0,0);
-	SSD2805WriteReg(0xbc, byteCount.w[0]);	//write to registers of SSD2805 at 0xbc, 0xbd
-	SSD2805WriteReg(0xbd, byteCount.w[1]);	//to set the size of block write
-	SSD2805WriteReg(0xbe, 0x0400);		//set threshold to max size for block write
+	for(i=0; i<sizeof(pattern)/sizeof(pattern[0]); i++)
+	{
+		SSD2805WriteReg(0xbc, pattern[i]);
+		if(SSD2805ReadReg(0xbc) != pattern[i])
+			ok = 0;
+	}
 
-	DisplayEnable();										
-	DisplaySetCommand(); 
-	DeviceWrite(0x2c);			
+	if(ok)
+		_pmpTiming = timing;
+	else
+	{
+		SSD2805PMPTimingSet(&_pmpTiming);		// fall back to the last good profile
+		_regShadowValid = 0;					// register contents unknown after bad writes
+	}
 
-	#if defined (USE_16BIT_PMP)
-	pixelCount = byteCount.Val;
-	//#elif defined (USE_8BIT_PMP)
-	#else
-	pixelCount = byteCount.Val>>1;
-	#endif
+	SSD2805WriteReg(0xbc, 0x0000);
+	return (ok);
+}
+#endif
 
-	DisplaySetData();
-	for(i=0; i<pixelCount; i++)
-		{
-		#if defined (USE_16BIT_PMP)
-			DeviceWrite(_color);
-		//#elif defined (USE_8BIT_PMP)
-		#else
-			DeviceWrite(_color);
-			DeviceWrite(_color>>8);
-		#endif
-		}
-	DisplayDisable();
+// Init sequence interpreter, see SSD2805SeqTask()
+static const BYTE		*_seqPtr;			// next opcode, NULL when no sequence runs
+static TIME_DEADLINE	_seqDeadline;		// end of a delay or of a poll
+static UINT32			_seqStart;			// TimeGetTicks() at SSD2805SeqStart()
+static UINT32			_seqPollStart;		// TimeGetTicks() at the first read of a poll
+static UINT32			_seqTicks;			// duration of the last sequence
+static BYTE				_seqWaiting;		// delay or poll of *_seqPtr in progress
+static BYTE				_seqMatches;		// poll reads matched in a row
+static BYTE				_seqTimeout;		// a poll ran out of time
+static BYTE				_seqResult = SSD2805_SEQ_OK;
+
+#define SSD_SEQ_WORD(p)		(((WORD)(p)[0]<<8) | (p)[1])
+
+/*********************************************************************
+* Function: void SSD2805SeqStart(const BYTE *pSeq)
+*
+* Overview: starts an init sequence, SSD2805SeqTask() runs it
+*
+********************************************************************/
+void SSD2805SeqStart(const BYTE *pSeq)
+{
+	_seqPtr = pSeq;
+	_seqWaiting = 0;
+	_seqTimeout = 0;
+	_seqResult = SSD2805_SEQ_BUSY;
+	_seqStart = TimeGetTicks();
+}
+
+/*********************************************************************
+* Function: BYTE SSD2805SeqTask(void)
+*
+* Overview: runs the opcodes of the sequence up to the next delay or
+*			poll that is not over yet. A poll reads the register once
+*			per call and ends when the masked value matched twice in a
+*			row, 0xFFFF (floating bus) never matches. A poll that runs
+*			out of time does not stop the sequence.
+*
+********************************************************************/
+BYTE SSD2805SeqTask(void)
+{
+	const BYTE *p = _seqPtr;
+	WORD value;
+
+	if(p == NULL)
+		return (_seqResult);
+
+	for(;;)
+	{
+		switch(p[0])
+		{
+			case SSD2805_OP_END:
+				_seqPtr = NULL;
+				_seqTicks = TimeGetTicks() - _seqStart;
+				_seqResult = (_seqTimeout)? SSD2805_SEQ_TIMEOUT : SSD2805_SEQ_OK;
+				return (_seqResult);
+
+			case SSD2805_OP_REG:
+				SSD2805WriteReg(p[1], SSD_SEQ_WORD(p + 2));
+				p += 4;
+				break;
+
+			case SSD2805_OP_DCS:
+				SSD2805WriteDCS(p[1], p + 3, p[2]);
+				p += 3 + p[2];
+				break;
+
+			case SSD2805_OP_VC:
+				SSD2805WriteReg(0xb8, p[1]);
+				p += 2;
+				break;
+
+			case SSD2805_OP_DELAY:
+				if(!_seqWaiting)
+				{
+					_seqDeadline = TimeDeadlineMs(SSD_SEQ_WORD(p + 1));
+					_seqWaiting = 1;
+				}
+				if(!TimeDeadlineExpired(_seqDeadline))
+				{
+					_seqPtr = p;
+					return (SSD2805_SEQ_BUSY);
+				}
+				_seqWaiting = 0;
+				p += 3;
+				break;
+
+			case SSD2805_OP_POLL:
+				if(!_seqWaiting)
+				{
+					_seqDeadline = TimeDeadlineMs(SSD_SEQ_WORD(p + 6));
+					_seqPollStart = TimeGetTicks();
+					_seqMatches = 0;
+					_seqWaiting = 1;
+				}
+				value = SSD2805ReadReg(p[1]);
+				if((value != 0xFFFF) && ((value & SSD_SEQ_WORD(p + 2)) == SSD_SEQ_WORD(p + 4)))
+					_seqMatches++;
+				else
+					_seqMatches = 0;
+				if(_seqMatches < 2)
+				{
+					if(!TimeDeadlineExpired(_seqDeadline))
+					{
+						_seqPtr = p;
+						return (SSD2805_SEQ_BUSY);
+					}
+					_seqTimeout = 1;
+				}
+				SSD_PERF(statusWaitTicks, TimeGetTicks() - _seqPollStart);
+				_seqWaiting = 0;
+				p += 8;
+				break;
+
+			default:
+				_seqPtr = NULL;					//not a sequence, stop here
+				_seqResult = SSD2805_SEQ_ERROR;
+				return (_seqResult);
+		}
+	}
+}
+
+/*********************************************************************
+* Function: BYTE SSD2805RunSeq(const BYTE *pSeq)
+*
+* Overview: runs an init sequence to the end
+*
+********************************************************************/
+BYTE SSD2805RunSeq(const BYTE *pSeq)
+{
+	BYTE result;
+
+	SSD2805SeqStart(pSeq);
+	while((result = SSD2805SeqTask()) == SSD2805_SEQ_BUSY);
+	return (result);
+}
+
+/*********************************************************************
+* Function: DWORD SSD2805SeqGetTime(void)
+*
+* Overview: duration of the last sequence run to the end, in us
+*
+********************************************************************/
+DWORD SSD2805SeqGetTime(void)
+{
+	return (_seqTicks/TIME_TICKS_PER_US);
+}
+
+// PLL on and wait for lock, PLL = clock*(BAh[7:0]+1)/((BAh[15:12]+1)*(BAh[11:8]+1))
+// = 20*(0x0f+1)/1*1 = 20*16 = 320MHz with default HardwareProfile.h. fVCO range
+// 225MHz..350MHz is checked at compile time in SSD2805.h.
+static const BYTE _seqPll[] =
+{
+	SSD2805_SEQ_REG(0xba, SSD_PLL_REG),
+	SSD2805_SEQ_REG(0xb9, 0x0001),			//enable PLL
+	SSD2805_SEQ_POLL(0xc6, 0x0080, 0x0080, SSD2805_PLL_LOCK_TIMEOUT_MS),
+	SSD2805_SEQ_END
+};
+
+// Bridge set-up once the PLL is locked
+static const BYTE _seqBridge[] =
+{
+	//SYS_CLK = TX_CLK/(BBh[7:6]+1), TX_CLK = external oscillator clock speed
+	//By default, SYS_CLK = 20MHz/(1+1)=10MHz. Measure SYS_CLK pin to verify it.
+	//LP clock = PLL/(8*(BBh[5:0]+1)) = 320/(8*(4+1)) = 8MHz, conform to AUO panel's spec, default LP = 8Mbps
+	SSD2805_SEQ_REG(0xbb, SSD_CLK_CTRL_REG),
+	SSD2805_SEQ_REG(0xd6, 0x0100),			//output sys_clk for debug
+#if defined (USE_SSD2805_VIDEO_MODE)
+	//RGB timing of the video stream, SSD2805 regenerates the same timing on MIPI link
+	SSD2805_SEQ_REG(0xb1, ((WORD)DISP_VER_PULSE_WIDTH<<8)|DISP_HOR_PULSE_WIDTH),	//VSA[15:8], HSA[7:0]
+	SSD2805_SEQ_REG(0xb2, ((WORD)DISP_VER_BACK_PORCH<<8)|DISP_HOR_BACK_PORCH),	//VBP[15:8], HBP[7:0]
+	SSD2805_SEQ_REG(0xb3, ((WORD)DISP_VER_FRONT_PORCH<<8)|DISP_HOR_FRONT_PORCH),	//VFP[15:8], HFP[7:0]
+	SSD2805_SEQ_REG(0xb4, DISP_HOR_RESOLUTION),	//HACT
+	SSD2805_SEQ_REG(0xb5, DISP_VER_RESOLUTION),	//VACT
+	SSD2805_SEQ_REG(0xb6, 0x000B),			//VM[3:2]=10 burst mode, VPF[1:0]=11 24-bit RGB888
+#endif
+	//EOT packet enable, write operation, it is a DCS packet
+	//HS clock is disabled, video mode disabled, in HS mode to send data
+	SSD2805_SEQ_REG(0xb7, 0x0243),
+	SSD2805_SEQ_END
+};
+
+// LG LH154Q01, 1.54" 240x240, 1-lane. AUO H154QN01 V2 (Samsung S6D04D2)
+// takes the same, SSD2805SeqH154QN01 is this table.
+const BYTE SSD2805SeqLH154Q01[] =
+{
+	SSD2805_SEQ_VC(0),
+	SSD2805_SEQ_DCS(0x11, 0),				//sleep-out
+	SSD2805_SEQ_DELAY(100),				//wait for AUO/LG panel after sleep out
+	SSD2805_SEQ_END
+};
+
+extern const BYTE SSD2805_PANEL_SEQ[];
+
+// Initialization state machine, see ResetDeviceTask()
+typedef enum
+{
+	INIT_IDLE = 0,
+	INIT_RESET_HIGH,			// RESET high >250ms (mainly for LH154Q01)
+	INIT_RESET_LOW,				// RESET low >5ms
+	INIT_RESET_RELEASE,			// RESET released 1ms, then panel VDDIO on
+	INIT_PANEL_POWER,			// 10ms before first MIPI command
+	INIT_PLL_LOCK,				// _seqPll, poll 0xC6 bit 7
+	INIT_PANEL_SEQ,				// SSD2805_PANEL_SEQ, sleep-out and its delay
+	INIT_CLEAR,					// clear GRAM in strips of SSD2805_INIT_CLEAR_ROWS
+	INIT_DONE
+} SSD2805_INIT_STATE;
+
+static SSD2805_INIT_STATE	_initState;
+static TIME_DEADLINE		_initDeadline;		// end of the current wait
+static WORD					_initRow;			// next row to clear
+
+/*********************************************************************
+* Function:  static void SSD2805InitWait(WORD ms, SSD2805_INIT_STATE next)
+*
+* Overview: sets the next state, entered once 'ms' have elapsed
+*
+********************************************************************/
+static void SSD2805InitWait(WORD ms, SSD2805_INIT_STATE next)
+{
+	_initDeadline = TimeDeadlineMs(ms);
+	_initState = next;
+}
+
+#ifdef USE_SSD2805_BACKLIGHT_PWM
+#define SSD_BL_PERIOD		(GetPeripheralClock()/SSD2805_BACKLIGHT_PWM_HZ)	//timer counts per PWM period
+
+static BYTE				_blLevel = 255;		// level set, target of a fade
+static volatile DWORD	_blDuty;			// duty in timer counts, 16.16 fixed point
+static volatile LONG	_blStep;			// added every PWM period during a fade
+static volatile DWORD	_blSteps;			// PWM periods left in the fade
+static WORD				_blDimSeconds;		// 0 if auto-dim is off
+static BYTE				_blDimLevel;
+static BYTE				_blDimmed;
+static UINT32			_blActivityUs;		// TimeGetUs() at the last activity
+
+/*********************************************************************
+* Function: static DWORD SSD2805BacklightDuty(BYTE level)
+*
+* Overview: duty in timer counts for a level, on a square law so
+*			that fades look even
+*
+********************************************************************/
+static DWORD SSD2805BacklightDuty(BYTE level)
+{
+	return (((DWORD)level*level*SSD_BL_PERIOD + 65024)/65025);
+}
+
+/*********************************************************************
+* Function: static void SSD2805BacklightOutput(DWORD duty)
+*
+* Overview: loads the PWM duty, taken at the next period. An active
+*			low backlight enable gets the inverted duty.
+*
+********************************************************************/
+static inline void SSD2805BacklightOutput(DWORD duty)
+{
+#if (BACKLIGHT_ENABLE_LEVEL == 0)
+	SSD_BL_OCRS = SSD_BL_PERIOD - duty;
+#else
+	SSD_BL_OCRS = duty;
+#endif
+}
+
+/*********************************************************************
+* Function: void SSD2805BacklightHandler(void)
+*
+* Overview: timer interrupt once per PWM period while a fade runs,
+*			steps the duty and stops itself at the end of the fade
+*
+********************************************************************/
+void __ISR(SSD_BL_VECTOR, IPL3AUTO) SSD2805BacklightHandler(void)
+{
+	SSD_BL_IF = 0;
+	if(_blSteps > 1)
+	{
+		_blSteps--;
+		_blDuty += _blStep;
+		SSD2805BacklightOutput(_blDuty >> 16);
+	}
+	else
+	{
+		_blSteps = 0;
+		_blDuty = SSD2805BacklightDuty(_blLevel) << 16;
+		SSD2805BacklightOutput(_blDuty >> 16);
+		SSD_BL_IE = 0;
+	}
+}
+
+/*********************************************************************
+* Function: static void SSD2805BacklightInit(void)
+*
+* Overview: starts the timer and the output compare in PWM mode
+*
+********************************************************************/
+static void SSD2805BacklightInit(void)
+{
+	SSD_BL_IE = 0;
+	SSD_BL_TMRCON = 0;
+	SSD_BL_OCCON = 0;
+	SSD_BL_TMR = 0;
+	SSD_BL_PR = SSD_BL_PERIOD - 1;			//prescaler 1:1
+
+	_blSteps = 0;
+	_blDuty = SSD2805BacklightDuty(_blLevel) << 16;
+	SSD2805BacklightOutput(_blDuty >> 16);
+	SSD_BL_OCR = SSD_BL_OCRS;
+	SSD_BLPinConfig();
+	SSD_BL_OCCONbits.OCTSEL = SSD_BL_OCTSEL;
+	SSD_BL_OCCONbits.OCM = 6;				//PWM, fault pin disabled
+	SSD_BL_OCCONbits.ON = 1;
+	SSD_BL_IP = 3;							//same as IPL3AUTO of the handler
+	SSD_BL_IF = 0;
+	SSD_BL_TMRCONbits.ON = 1;
+	_blActivityUs = TimeGetUs();
+}
+
+/*********************************************************************
+* Function: static void SSD2805BacklightRamp(BYTE level, WORD ms)
+*
+* Overview: fades to 'level' without changing the level kept by
+*			SSD2805SetBacklight(), used by auto-dim
+*
+********************************************************************/
+static void SSD2805BacklightRamp(BYTE level, WORD ms)
+{
+	DWORD steps = ((DWORD)ms*SSD2805_BACKLIGHT_PWM_HZ)/1000;
+	DWORD target = SSD2805BacklightDuty(level) << 16;
+
+	SSD_BL_IE = 0;
+	if(steps == 0)
+	{
+		_blSteps = 0;
+		_blDuty = target;
+		SSD2805BacklightOutput(_blDuty >> 16);
+		return;
+	}
+	_blStep = ((LONG)target - (LONG)_blDuty)/(LONG)steps;
+	_blSteps = steps;
+	SSD_BL_IF = 0;
+	SSD_BL_IE = 1;
+}
+
+/*********************************************************************
+* Function: void SSD2805BacklightFade(BYTE level, WORD ms)
+*
+* Overview: ramps the backlight to 'level' from the timer interrupt
+*
+********************************************************************/
+void SSD2805BacklightFade(BYTE level, WORD ms)
+{
+	_blLevel = level;
+	_blDimmed = 0;
+	_blActivityUs = TimeGetUs();
+	SSD2805BacklightRamp(level, ms);
+}
+
+/*********************************************************************
+* Function: void SSD2805BacklightAutoDim(WORD seconds, BYTE dimLevel)
+*
+* Overview: sets the auto-dim time and level, the time is clamped to
+*			SSD2805_BACKLIGHT_DIM_MAX_S
+*
+********************************************************************/
+void SSD2805BacklightAutoDim(WORD seconds, BYTE dimLevel)
+{
+	if(seconds > SSD2805_BACKLIGHT_DIM_MAX_S)
+		seconds = SSD2805_BACKLIGHT_DIM_MAX_S;	//the us time stamps wrap after 4294s
+	_blDimSeconds = seconds;
+	_blDimLevel = dimLevel;
+	SSD2805BacklightActivity();
+}
+
+/*********************************************************************
+* Function: void SSD2805BacklightActivity(void)
+*
+* Overview: restarts the auto-dim time, undims the backlight
+*
+********************************************************************/
+void SSD2805BacklightActivity(void)
+{
+	_blActivityUs = TimeGetUs();
+	if(_blDimmed)
+	{
+		_blDimmed = 0;
+		SSD2805BacklightRamp(_blLevel, SSD2805_BACKLIGHT_WAKE_FADE_MS);
+	}
+}
+
+/*********************************************************************
+* Function: void SSD2805BacklightTask(void)
+*
+* Overview: starts the auto-dim fade when the time is up
+*
+********************************************************************/
+void SSD2805BacklightTask(void)
+{
+	if(_blDimSeconds && !_blDimmed && (_blDimLevel < _blLevel) &&
+		((TimeGetUs() - _blActivityUs) >= (UINT32)_blDimSeconds*1000000ul))
+	{
+		_blDimmed = 1;
+		SSD2805BacklightRamp(_blDimLevel, SSD2805_BACKLIGHT_DIM_FADE_MS);
+	}
+}
+#endif	//USE_SSD2805_BACKLIGHT_PWM
+
+/*********************************************************************
+* Function:  void ResetDeviceStart(void)
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: starts the non-blocking initialization of SSD2805 and the
+*			panel. Configures the MCU interface and asserts the first
+*			reset phase, the rest is done by ResetDeviceTask().
+*
+********************************************************************/
+void ResetDeviceStart(void)
+{
+	_regShadowValid = 0;		// registers return to defaults on reset
+    SSD_PowerOn();
+    SSD_PowerConfig();			// VDDIO switch for SSD2805
+
+    DisplayCmdDataConfig();     // enable RS line
+    DisplayDisable();
+    DisplayConfig();			// CSX# as chip select, driven high on start-up
+ 
+#ifdef USE_SSD2805_BACKLIGHT_PWM
+	SSD2805BacklightInit();		// PWM at the last level, full on power-up
+#else
+    DisplayBacklightOn();       // initially set the backlight to on
+    DisplayBacklightConfig();   // set the backlight control pin
+#endif
+   
+    /////////////////////////////////////////////////////////////////////
+    // Initialize PMP interface for 8080
+    /////////////////////////////////////////////////////////////////////
+	#if defined (USE_GFX_PMP)
+	    // PMP setup
+	    PMMODE = 0;
+	    PMCON = 0;
+	    PMMODEbits.MODE = 2;                //Intel 80 master interface
+	    _pmpTiming = _pmpTimingSafe;		//slowest timing while SSD2805 is in reset, faster profiles
+	    PMMODEbits.WAITB = _pmpTiming.waitB;	//are computed from the SSD2805 clock and verified once
+	    PMMODEbits.WAITM = _pmpTiming.waitM;	//it is running, see SSD2805PMPTimingSwitch()
+	    PMMODEbits.WAITE = _pmpTiming.waitE;
+	    #if defined(USE_SSD2805_PMP_IRQ)
+	    PMMODEbits.IRQM = 1;                // interrupt flag at the end of each read/write cycle
+	    #endif
+	    #if defined(USE_16BIT_PMP)
+	    PMMODEbits.MODE16 = 1;              // 16 bit mode
+	    #elif defined(USE_8BIT_PMP)
+	    PMMODEbits.MODE16 = 0;              // 8 bit mode
+	    #endif
+  
+    	PMCONbits.PTRDEN = 1;               // enable RD line
+    	PMCONbits.PTWREN = 1;               // enable WR line			
+    	PMCONbits.PMPEN = 1;                // enable PMP	
+    /////////////////////////////////////////////////////////////////////
+    // Initialize SPI interface, SCK at SSD_SPI_CLOCK_BEFORE_PLL
+    /////////////////////////////////////////////////////////////////////
+	#elif defined (USE_GFX_SPI)
+	    DriverInterfaceInit();
+	#endif
+		
+	SSD_ResetDisable();		// Keep RESET pin high for SSD2805 & LH154Q01  >250ms (mainly for LH154Q01) 		
+    SSD_ResetConfig();			// set RESET pin an output
+	SSD2805InitWait(300, INIT_RESET_HIGH);
+}
+
+/*********************************************************************
+* Function:  BYTE ResetDeviceTask(void)
+*
+* PreCondition: ResetDeviceStart()
+*
+* Input: none
+*
+* Output: 1 when initialization is complete, 0 while in progress
+*
+* Side Effects: none
+*
+* Overview: advances the initialization of SSD2805 and the panel by one
+*			step. Call it from the main loop or from a periodic timer
+*			interrupt, every call returns without waiting. Delays are
+*			timed with the core timer: reset, PLL, clock control,
+*			packet format, panel sequence SSD2805_PANEL_SEQ, pixel
+*			format, clear, display on and, with USE_SSD2805_TE_SYNC,
+*			tearing sync on.
+*
+* Note: no other driver call may be made before this returns 1
+*
+********************************************************************/
+BYTE ResetDeviceTask(void)
+{
+	BYTE result;
+
+	if((_initState != INIT_PLL_LOCK) && (_initState != INIT_PANEL_SEQ) && (_initState != INIT_CLEAR) && (_initState != INIT_DONE) && (_initState != INIT_IDLE))
+	{
+		if(!TimeDeadlineExpired(_initDeadline))
+			return (0);						// current wait not over yet
+	}
+
+	switch(_initState)
+	{
+		case INIT_IDLE:
+			ResetDeviceStart();
+			return (0);
+
+		case INIT_RESET_HIGH:
+		    SSD_ResetEnable();				// Keep RESET pin low for SSD2805 & LH154Q01 >5ms
+			SSD2805InitWait(10, INIT_RESET_LOW);
+			return (0);
+
+		case INIT_RESET_LOW:
+			SSD_ResetDisable();				// now release RESET from low and keep RESET high for normal operation
+			SSD2805InitWait(1, INIT_RESET_RELEASE);
+			return (0);
+
+		case INIT_RESET_RELEASE:
+			LH_PowerOn();					// turn VDDIO of LH154Q01 on
+			LH_PowerConfig();
+			SSD2805InitWait(10, INIT_PANEL_POWER);	// wait 10ms to start MIPI command
+			return (0);
+
+		case INIT_PANEL_POWER:
+		#if defined (USE_GFX_PMP)
+			//Step 0: SSD2805 runs from the external oscillator, PMP timing from 3T with T=1/SSD_TX_CLK_MHZ
+			SSD2805PMPTimingSwitch(SSD_TX_CLK_MHZ);
+		#endif
+			//Step 1: Set PLL, then poll for lock one read per call. On timeout
+			//carry on anyway, the timeout is longer than the 2ms fixed delay used before.
+			SSD2805SeqStart(_seqPll);
+			_initState = INIT_PLL_LOCK;
+			return (0);
+
+		case INIT_PLL_LOCK:
+			result = SSD2805SeqTask();
+			if(result == SSD2805_SEQ_BUSY)
+				return (0);
+
+			//Step 2: Now it is safe to set PMP at max. speed
+		#if defined (USE_GFX_PMP)
+			if(result == SSD2805_SEQ_OK)		//PLL locked, PMP timing from 3T with T=1/SSD_PLL_MHZ
+				SSD2805PMPTimingSwitch(SSD_PLL_MHZ);
+		#elif defined (USE_GFX_SPI)
+			DriverInterfaceSetClock(SSD_SPI_CLOCK);
+		#endif
+
+			//Step 3-5: clock control, packet format, video timing in video mode
+			SSD2805RunSeq(_seqBridge);
+
+			//Step 6: panel power-on sequence, sleep-out and VC
+			SSD2805SeqStart(SSD2805_PANEL_SEQ);
+			_initState = INIT_PANEL_SEQ;
+			return (0);
+
+		case INIT_PANEL_SEQ:
+			if(SSD2805SeqTask() == SSD2805_SEQ_BUSY)
+				return (0);
+
+			//Step 7: Now configuration parameters sent to AUO
+		#if defined (USE_SSD2805_VIDEO_MODE)
+			{
+				static const BYTE format = 0x07;	//24-bit color, same as VPF in 0xB6
+				SSD2805WriteDCS(0x3a, &format, 1);	//DCS set pixel format
+			}
+		#else
+			SSD2805SetPixelFormat(SSD2805_PIXEL_FORMAT);	//0x05 (16-bit), 0x06 (18-bit) or 0x07 (24-bit color)
+			SSD2805SetOrientation(DISP_ORIENTATION, SSD2805_MIRROR_NONE);	//panel maps the window, no software transform
+
+			SetColor(0);					//debug here for different color on POR
+			_initRow = 0;
+		#endif
+			_initState = INIT_CLEAR;
+			return (0);
+
+		case INIT_CLEAR:
+		#if !defined (USE_SSD2805_VIDEO_MODE)
+			// clear GRAM a strip per call, instead of ClearDevice() in one go.
+			// Video mode has nothing to clear, the picture comes from the RGB interface.
+			{
+				SSD2805_BURST strip;
+
+				strip.left = 0;
+				strip.right = GetMaxX();
+				strip.top = _initRow;
+				_initRow += SSD2805_INIT_CLEAR_ROWS;
+				strip.bottom = (_initRow > GetMaxY())? GetMaxY() : (_initRow - 1);
+				strip.pData = NULL;
+				strip.color = _color;
+				SSD2805WriteBurst(&strip);
+				if(_initRow <= GetMaxY())
+					return (0);
+			}
+		#endif
+
+			SSD2805WriteDCS(0x29, NULL, 0);		//display ON DCS command to AUO panel
+
+		#if defined (USE_SSD2805_VIDEO_MODE)
+			//Step 8: panel is on, switch SSD2805 to video mode. From now on display data comes
+			//from the RGB interface, DCS commands are sent in the blanking period (BLLP).
+			SSD2805WriteReg(0xB7, 0x024B);	//as Step 4 with VEN (bit 3) set
+		#elif defined (USE_SSD2805_TE_SYNC)
+			//Step 8: TE output of the panel and its input capture on, frames are presented in V-blank
+			SSD2805SetTearingSync(1);
+		#endif
+			_initState = INIT_DONE;
+			return (1);
+
+		case INIT_DONE:
+		default:
+			return (1);
+	}
+}
+
+/*********************************************************************
+* Function:  void ResetDevice()
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: resets SSD2805, initializes PMP/SPI interface. Blocking
+*			wrapper of ResetDeviceStart() and ResetDeviceTask().
+*
+* Note: There are two operating clock speed before and after PLL
+*		locked in SSD2805. External oscillator is 20MHz. After
+*		PLL, the operating frequency can be as high as 500MHz.
+*		
+********************************************************************/
+void ResetDevice(void)
+{
+	ResetDeviceStart();
+	while(!ResetDeviceTask());
+}
+
+static BYTE				_sleeping;			// panel in sleep-in, SSD2805 in ULPS with PLL off
+static WORD				_sleepConfig;		// 0xB7 before sleep-in
+static TIME_DEADLINE	_sleepDeadline;		// earliest sleep-out
+
+/*********************************************************************
+* Function: void SSD2805SetBacklight(BYTE level)
+*
+* Overview: sets the PWM backlight, or the panel brightness (DCS 0x51)
+*			without USE_SSD2805_BACKLIGHT_PWM
+*
+* Input: level - 0 (off) to 255
+*
+* Output: none
+*
+********************************************************************/
+#ifdef USE_SSD2805_BACKLIGHT_PWM
+void SSD2805SetBacklight(BYTE level)
+{
+	SSD2805BacklightFade(level, 0);
+}
+
+BYTE SSD2805GetBacklight(void)
+{
+	return (_blLevel);
+}
+#else
+static BYTE		_blLevel = 255;
+
+void SSD2805SetBacklight(BYTE level)
+{
+	SSD2805SetPanelBrightness(level);
+	_blLevel = level;
+}
+
+BYTE SSD2805GetBacklight(void)
+{
+	return (_blLevel);
+}
+#endif
+
+/*********************************************************************
+* Function: void SSD2805SetPanelBrightness(BYTE value)
+*
+* Overview: sends DCS write_display_brightness (0x51)
+*
+********************************************************************/
+void SSD2805SetPanelBrightness(BYTE value)
+{
+	SSD2805WriteDCS(0x51, &value, 1);		//DCS write_display_brightness
+}
+
+/*********************************************************************
+* Function: void SSD2805SetPanelControl(BYTE ctrl, BYTE cabc)
+*
+* Overview: sends DCS write_ctrl_display (0x53) and
+*			write_content_adaptive_brightness (0x55)
+*
+********************************************************************/
+void SSD2805SetPanelControl(BYTE ctrl, BYTE cabc)
+{
+	SSD2805WriteDCS(0x53, &ctrl, 1);		//DCS write_ctrl_display
+	SSD2805WriteDCS(0x55, &cabc, 1);		//DCS write_content_adaptive_brightness
+}
+
+/*********************************************************************
+* Function: void SSD2805SetIdleMode(BYTE enable)
+*
+* Overview: turns the panel idle mode (8 colors) on with DCS 0x39 or
+*			off with DCS 0x38
+*
+* Input: enable - 1 for idle mode, 0 for full colors
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805SetIdleMode(BYTE enable)
+{
+	SSD2805WriteDCS((enable)? 0x39 : 0x38, NULL, 0);	//DCS enter/exit_idle_mode
+}
+
+/*********************************************************************
+* Function: void SSD2805SetPartialArea(WORD startRow, WORD endRow)
+*
+* Overview: sets the partial area with DCS 0x30 and enters partial
+*			mode with DCS 0x12
+*
+* Input: startRow, endRow - rows shown, inclusive
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805SetPartialArea(WORD startRow, WORD endRow)
+{
+	BYTE area[4];
+
+	area[0] = (BYTE)(startRow>>8);			//SR[15:8]
+	area[1] = (BYTE)startRow;				//SR[7:0]
+	area[2] = (BYTE)(endRow>>8);			//ER[15:8]
+	area[3] = (BYTE)endRow;					//ER[7:0]
+	SSD2805WriteDCS(0x30, area, 4);			//DCS set_partial_area
+	SSD2805WriteDCS(0x12, NULL, 0);			//DCS enter_partial_mode
+}
+
+/*********************************************************************
+* Function: void SSD2805SetNormalMode(void)
+*
+* Overview: leaves partial mode with DCS 0x13
+*
+********************************************************************/
+void SSD2805SetNormalMode(void)
+{
+	SSD2805WriteDCS(0x13, NULL, 0);			//DCS enter_normal_mode
+}
+
+/*********************************************************************
+* Function: void SSD2805SleepIn(void)
+*
+* Overview: puts the panel to sleep with DCS 0x10, GRAM is kept. The
+*			SSD2805 then stops the video stream, puts the MIPI lanes
+*			in ULPS (0xB7 SLP) and turns the PLL off, the interface
+*			drops to the oscillator timing.
+*
+********************************************************************/
+void SSD2805SleepIn(void)
+{
+	if(_sleeping)
+		return;
+
+	SSD2805TxWait();
+	SSD2805WriteDCS(0x10, NULL, 0);			//DCS enter_sleep_mode
+	_sleepDeadline = TimeDeadlineMs(120);	//sleep-out no sooner than 120ms after sleep-in
+	DelayMsYield(5);						//panel takes the next command after 5ms
+
+	_sleepConfig = SSD2805ReadReg(0xb7);
+	SSD2805WriteReg(0xb7, (_sleepConfig & ~0x0008) | 0x0004);	//VEN off, SLP on, lanes to ULPS
+	SSD2805WriteReg(0xb9, 0x0000);			//PLL off
+#if defined (USE_GFX_PMP)
+	SSD2805PMPTimingSwitch(SSD_TX_CLK_MHZ);
+#elif defined (USE_GFX_SPI)
+	DriverInterfaceSetClock(SSD_SPI_CLOCK_BEFORE_PLL);
+#endif
+	_sleeping = 1;
+}
+
+/*********************************************************************
+* Function: BYTE SSD2805SleepOut(void)
+*
+* Overview: starts the PLL, leaves ULPS and wakes the panel with DCS
+*			0x11. GRAM was kept, there is nothing to redraw.
+*
+* Output: 1 if the PLL locked, 0 if the interface stays at the
+*		  oscillator timing
+*
+********************************************************************/
+BYTE SSD2805SleepOut(void)
+{
+	BYTE locked;
+
+	if(!_sleeping)
+		return (1);
+
+	locked = (SSD2805RunSeq(_seqPll) == SSD2805_SEQ_OK);	//enable PLL, wait for lock
+	if(locked)
+	{
+	#if defined (USE_GFX_PMP)
+		SSD2805PMPTimingSwitch(SSD_PLL_MHZ);
+	#elif defined (USE_GFX_SPI)
+		DriverInterfaceSetClock(SSD_SPI_CLOCK);
+	#endif
+	}
+	SSD2805WriteReg(0xb7, _sleepConfig & ~0x000C);	//SLP off, command mode for sleep-out
+
+	while(!TimeDeadlineExpired(_sleepDeadline))
+		TimeYield();
+	SSD2805WriteDCS(0x11, NULL, 0);			//DCS exit_sleep_mode
+	DelayMsYield(5);						//panel takes the next command after 5ms
+
+	SSD2805WriteReg(0xb7, _sleepConfig);	//video stream back on in video mode
+	_sleeping = 0;
+	return (locked);
+}
+
+#ifdef USE_TRANSPARENT_COLOR
+/*********************************************************************
+* Function:  void TransparentColorEnable(GFX_COLOR color)
+*
+* Overview: Sets current transparent color.
+*
+* PreCondition: none
+*
+* Input: color - Color value chosen.
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+void TransparentColorEnable(GFX_COLOR color)
+{
+    _colorTransparent = color;    
+    _colorTransparentEnable = TRANSPARENT_COLOR_ENABLE;
+
+}
+#endif
+
+
+/*********************************************************************
+* Function: void PutPixel(SHORT x, SHORT y)
+*
+* Overview: Put pixel with the given x,y coordinate position.
+*
+* PreCondition: none
+*
+* Input: x - x position of the pixel.
+*		 y - y position of the pixel.
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+#ifdef USE_SSD2805_CMD_MODE
+void PutPixel(SHORT x, SHORT y)
+{
+	SetAddress(x,y);
+
+	SSD2805PlanTransfer(SSD_BUS_PADDED(_pixelBytes), _pixelBytes);	//a single pixel of 2 or 3 bytes depending on pixel format
+	SSD_TRACE(SSD2805_TRACE_BURST, 0x2c, _pixelBytes);
+	SSD_PERF(bursts, 1);
+	SSD_PERF(burstBytes, _pixelBytes);
+	SSD_PERF(bytesWritten, 1 + _pixelBytes);
+	SSD2805TxWait();
+	DisplayEnable();										
+	DisplaySetCommand(); DeviceWrite(0x2c);		
+								
+	DisplaySetData();
+	SSD2805WritePixels(NULL, _color, 1);	//releases chip select
+}
+#endif	//USE_SSD2805_CMD_MODE
+
+#ifdef USE_SSD2805_CMD_MODE
+/*********************************************************************
+* Function: static BYTE SSD2805ReadPixels(BYTE cmd, GFX_COLOR *pDst, WORD count)
+*
+* Overview: reads 'count' pixels with a single memory read, 0x2E from
+*			the window origin or 0x3E to continue the last read.
+*			count*_pixelBytes must not exceed SSD2805_READ_CHUNK_BYTES.
+*			pDst is left as it is if the read fails.
+*
+* Output: SSD2805_READ_OK or an error code of SSD2805ReadDCSEx(),
+*		  SSD2805_READ_NO_DATA if fewer bytes were returned
+*
+********************************************************************/
+static BYTE SSD2805ReadPixels(BYTE cmd, GFX_COLOR *pDst, WORD count)
+{
+	BYTE buf[SSD2805_READ_DUMMY_BYTES + SSD2805_READ_CHUNK_BYTES];
+	const BYTE *p = buf + SSD2805_READ_DUMMY_BYTES;
+	WORD len = SSD2805_READ_DUMMY_BYTES + count*_pixelBytes;
+	WORD expected = len;
+	DWORD bus;
+	BYTE result;
+
+	result = SSD2805ReadDCSEx(cmd, buf, &len);
+	if(result != SSD2805_READ_OK)
+		return (result);
+	if(len < expected)
+		return (SSD2805_READ_NO_DATA);
+
+	while(count--)
+	{
+		bus = ((DWORD)p[1]<<8) | p[0];		//lower byte first as written
+		if(_pixelBytes == 3)
+			bus |= (DWORD)p[2]<<16;
+		*pDst++ = SSD2805FromBusColor(bus);
+		p += _pixelBytes;
+	}
+	return (SSD2805_READ_OK);
+}
+
+/*********************************************************************
+* Function: WORD GetPixel(SHORT x, SHORT y)
+*
+* PreCondition: none
+*
+* Input: pixel position
+*
+* Output: pixel color, 0 if the read failed, see SSD2805GetReadInfo()
+*
+* Side Effects: none
+*
+* Overview: returns pixel at given position, all of its bytes are
+*			read with one DCS 0x2E
+*
+********************************************************************/
+GFX_COLOR GetPixel(SHORT x, SHORT y)
+{
+	GFX_COLOR color;
+
+	SetAddress(x,y);
+
+	if(SSD2805ReadPixels(0x2E, &color, 1) != SSD2805_READ_OK)
+		return (0);
+	return (color);
+}
+#endif
+
+/*********************************************************************
+* Function: IsDeviceBusy()
+*
+* Overview: Returns non-zero if LCD controller is busy 
+*           (previous drawing operation is not completed).
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: Busy status.
+*
+* Side Effects: none
+*
+********************************************************************/
+
+WORD IsDeviceBusy(void)
+{  
+#if defined (USE_GFX_PMP) && defined (USE_SSD2805_PMP_IRQ)
+    return (_pmpTxBusy);
+#else
+    return (0);
+#endif
+}
+
+#ifdef USE_SSD2805_CMD_MODE
+// Frame presentation queue, bursts are written in SSD2805PresentFrame()
+static SSD2805_BURST    _burstQueue[SSD2805_BURST_QUEUE_SIZE];
+static WORD             _burstCount;
+
+#ifdef USE_SSD2805_TE_SYNC
+static BYTE             _teEnable;
+static volatile WORD    _teCount;			//incremented on every TE rising edge
+static volatile DWORD   _teTimestamp;		//core timer at last TE edge
+static volatile DWORD   _tePeriod;			//core timer ticks between the last two TE edges
+
+/*********************************************************************
+* Function: void SSD2805TEHandler(void)
+*
+* Overview: Input capture interrupt on TE rising edge, i.e. start of
+*			vertical blanking of the panel. Records the time stamp
+*			and the measured frame period.
+*
+********************************************************************/
+void __ISR(SSD_TE_VECTOR, IPL5AUTO) SSD2805TEHandler(void)
+{
+	DWORD now = TimeGetTicks();
+
+	while(SSD_TE_ICCONbits.ICBNE)		//captured timer values are not used
+		SSD_TE_ICBUF;
+
+	_tePeriod = now - _teTimestamp;
+	_teTimestamp = now;
+	_teCount++;
+	SSD_TE_IF = 0;
+}
+
+/*********************************************************************
+* Function: static BYTE SSD2805WaitTE(void)
+*
+* Overview: waits for the next TE edge, at most SSD2805_TE_TIMEOUT_MS.
+*			The yield hook of the time service is called while waiting.
+*
+* Output: 1 if synchronized, 0 on timeout (TE not running)
+*
+********************************************************************/
+static BYTE SSD2805WaitTE(void)
+{
+	WORD count = _teCount;
+	TIME_DEADLINE deadline = TimeDeadlineMs(SSD2805_TE_TIMEOUT_MS);
+
+	while(count == _teCount)
+	{
+		if(TimeDeadlineExpired(deadline))
+			return (0);
+		TimeYield();
+	}
+	return (1);
+}
+
+/*********************************************************************
+* Function: static WORD SSD2805GetScanLine(void)
+*
+* Overview: estimates the line being read out by the panel from the time
+*			elapsed since the last TE edge and the measured frame period.
+*			TE rises at the start of V-blank, SSD2805_TE_BLANK_LINES
+*			line times pass before line 0. The estimate is kept
+*			SSD2805_TE_MARGIN_LINES behind, writes must not overtake
+*			the scan.
+*
+* Output: 0..DISP_VER_RESOLUTION, DISP_VER_RESOLUTION when frame is done
+*
+********************************************************************/
+static WORD SSD2805GetScanLine(void)
+{
+	DWORD elapsed = TimeGetTicks() - _teTimestamp;
+	DWORD period = _tePeriod;
+	DWORD line;
+
+	if((period == 0) || (elapsed >= period))
+		return (DISP_VER_RESOLUTION);
+	line = (DWORD)(((QWORD)elapsed*(DISP_VER_RESOLUTION + SSD2805_TE_BLANK_LINES))/period);
+	if(line < SSD2805_TE_BLANK_LINES + SSD2805_TE_MARGIN_LINES)
+		return (0);
+	return ((WORD)(line - SSD2805_TE_BLANK_LINES - SSD2805_TE_MARGIN_LINES));
+}
+
+/*********************************************************************
+* Function: void SSD2805SetTearingSync(BYTE enable)
+*
+* Overview: enables the panel TE output with DCS 0x35 (V-blank only)
+*			and the input capture on the TE pin, or disables both
+*			with DCS 0x34
+*
+* Input: enable - 1 to enable, 0 to disable
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805SetTearingSync(BYTE enable)
+{
+	SSD_TE_IE = 0;
+	SSD_TE_ICCON = 0;
+
+	if(enable)
+	{
+		static const BYTE mode = 0x00;			//TE on V-blank only
+
+		SSD2805WriteDCS(0x35, &mode, 1);		//DCS tearing effect line on
+
+		_teTimestamp = TimeGetTicks();
+		_tePeriod = 0;
+
+		SSD_TEPinConfig();
+		SSD_TE_ICCONbits.ICM = 3;				//capture every rising edge
+		SSD_TE_ICCONbits.ICI = 0;				//interrupt on every capture
+		SSD_TE_ICCONbits.ON = 1;
+		SSD_TE_IP = 5;							//same as IPL5AUTO of the handler
+		SSD_TE_IF = 0;
+		SSD_TE_IE = 1;
+	}
+	else
+	{
+		SSD2805WriteDCS(0x34, NULL, 0);			//DCS tearing effect line off
+	}
+	_teEnable = enable;
+}
+#endif	//USE_SSD2805_TE_SYNC
+#endif	//USE_SSD2805_CMD_MODE
+
+/*********************************************************************
+* Function: void ClearDevice(void)
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: clears screen with current color 
+*
+* Note: none
+*
+********************************************************************/
+#ifdef USE_SSD2805_CMD_MODE
+void ClearDevice(void)
+{
+	SSD2805_BURST screen;
+
+#ifdef USE_SSD2805_TE_SYNC
+	if(_teEnable)
+		SSD2805WaitTE();					//start at V-blank, the write follows the scan line
+#endif
+	// one burst over the whole screen, byte count from the pixel format
+	screen.left = 0;
+	screen.top = 0;
+	screen.right = GetMaxX();
+	screen.bottom = GetMaxY();
+	screen.pData = NULL;
+	screen.color = _color;
+	SSD2805WriteBurst(&screen);
+}
+
+/*********************************************************************
+* Function: static DWORD SSD2805BeginBurst(SHORT left, SHORT top, SHORT right, SHORT bottom)
+*
+* Overview: sets the window and TDC size for a memory write (0x2C)
+*			burst over the rectangle and sends the command. The pixels
+*			follow with one or more SSD2805StreamPixels() calls.
+*
+* Output: number of pixels the burst takes
+*
+********************************************************************/
+static DWORD SSD2805BeginBurst(SHORT left, SHORT top, SHORT right, SHORT bottom)
+{
+	DWORD byteCount;
+	DWORD pixelCount;
+
+	pixelCount = (DWORD)(right - left + 1)*(bottom - top + 1);
+	byteCount = pixelCount*_pixelBytes;
+
+	SSD2805SetWindow(left, top, right, bottom);
+	SSD2805PlanTransfer(SSD_BUS_PADDED(byteCount), _pixelBytes);	//size of block write, long packets for large ones
+
+	SSD_TRACE(SSD2805_TRACE_BURST, 0x2c, byteCount);
+	SSD_PERF(bursts, 1);
+	SSD_PERF(burstBytes, byteCount);
+	SSD_PERF(bytesWritten, 1 + byteCount);
+	SSD2805TxWait();
+	DisplayEnable();
+	DisplaySetCommand();
+	DeviceWrite(0x2c);
+	DisplayDisable();
+	return (pixelCount);
+}
+
+/*********************************************************************
+* Function: static void SSD2805StreamPixels(const GFX_COLOR *pData, GFX_COLOR color, DWORD count)
+*
+* Overview: writes the next 'count' pixels of a burst started with
+*			SSD2805BeginBurst(), see SSD2805WritePixels()
+*
+********************************************************************/
+static void SSD2805StreamPixels(const GFX_COLOR *pData, GFX_COLOR color, DWORD count)
+{
+	SSD2805TxWait();
+	DisplayEnable();
+	DisplaySetData();
+	SSD2805WritePixels(pData, color, count);	//releases chip select
+}
+
+/*********************************************************************
+* Function: static void SSD2805WriteBurst(const SSD2805_BURST *pBurst)
+*
+* Overview: writes one rectangle as a single memory write (0x2C)
+*			burst: solid color if pBurst->pData is NULL, otherwise
+*			pixels from pBurst->pData, row by row
+*
+* Note: with USE_SSD2805_PMP_IRQ the pixels are written from the PMP
+*		interrupt and the function returns before they are sent
+*
+********************************************************************/
+static void SSD2805WriteBurst(const SSD2805_BURST *pBurst)
+{
+	DWORD pixelCount;
+
+	pixelCount = SSD2805BeginBurst(pBurst->left, pBurst->top, pBurst->right, pBurst->bottom);
+	SSD2805StreamPixels(pBurst->pData, pBurst->color, pixelCount);
+}
+
+/*********************************************************************
+* Function: static void SSD2805WriteRaw(const BYTE *pData, DWORD bytes)
+*
+* Overview: writes bytes as they are, no conversion. The 8-bit loop is
+*			unrolled by 8, with 16-bit PMP a word aligned buffer is read
+*			a word per cycle. Chip select must be enabled and SDC set
+*			for data, chip select is released when done.
+*
+* Note: with USE_SSD2805_PMP_IRQ (8-bit PMP) long buffers are written
+*		from the PMP interrupt and the function returns before they
+*		are sent
+*
+********************************************************************/
+static void SSD2805WriteRaw(const BYTE *pData, DWORD bytes)
+{
+#if defined (USE_GFX_SPI) && defined (SSD_SPI_DMA_CHANNEL)
+	WORD len;
+
+	while(bytes)
+	{
+		len = (bytes > 0x8000)? 0x8000 : (WORD)bytes;
+		SSD2805SPIWriteDMA(pData, len);
+		pData += len;
+		bytes -= len;
+	}
+#else
+	#if defined (USE_GFX_PMP) && defined (USE_SSD2805_PMP_IRQ) && !defined (USE_16BIT_PMP)
+	if(bytes >= SSD2805_PMP_IRQ_MIN_CYCLES)
+	{
+		SSD2805PMPTxStart(pData, 0, bytes);	//chip select released by the interrupt
+		return;
+	}
+	#endif
+	#if defined (USE_16BIT_PMP)
+	if(((DWORD)pData & 1) == 0)
+	{
+		const WORD *pWord = (const WORD *)pData;
+
+		while(bytes >= 8)
+		{
+			DeviceWrite(pWord[0]);
+			DeviceWrite(pWord[1]);
+			DeviceWrite(pWord[2]);
+			DeviceWrite(pWord[3]);
+			pWord += 4;
+			bytes -= 8;
+		}
+		pData = (const BYTE *)pWord;
+	}
+	while(bytes >= 2)
+	{
+		DeviceWrite(((WORD)pData[1]<<8) | pData[0]);	//lower byte sent first on MIPI link
+		pData += 2;
+		bytes -= 2;
+	}
+	if(bytes)
+		DeviceWrite(pData[0]);
+	#else
+	while(bytes >= 8)
+	{
+		DeviceWrite(pData[0]);
+		DeviceWrite(pData[1]);
+		DeviceWrite(pData[2]);
+		DeviceWrite(pData[3]);
+		DeviceWrite(pData[4]);
+		DeviceWrite(pData[5]);
+		DeviceWrite(pData[6]);
+		DeviceWrite(pData[7]);
+		pData += 8;
+		bytes -= 8;
+	}
+	while(bytes--)
+		DeviceWrite(*pData++);
+	#endif
+#endif
+	DisplayDisable();
+}
+
+#if defined (USE_16BIT_PMP)
+// Raw burst in pieces, see SSD2805RawWrite()
+static DWORD	_rawLeft;					// bytes of the burst not yet passed in
+static BYTE		_rawHeld;					// 1 if _rawHeldByte waits for its pair
+static BYTE		_rawHeldByte;
+#endif
+
+/*********************************************************************
+* Function: DWORD SSD2805RawBegin(SHORT left, SHORT top, SHORT right, SHORT bottom)
+*
+* Overview: starts a memory write burst over the rectangle for raw
+*			pixel data, see SSD2805RawWrite()
+*
+********************************************************************/
+DWORD SSD2805RawBegin(SHORT left, SHORT top, SHORT right, SHORT bottom)
+{
+	DWORD bytes = SSD2805BeginBurst(left, top, right, bottom)*_pixelBytes;
+
+#if defined (USE_16BIT_PMP)
+	_rawLeft = bytes;
+	_rawHeld = 0;
+#endif
+	return (bytes);
+}
+
+/*********************************************************************
+* Function: void SSD2805RawWrite(const BYTE *pData, DWORD bytes)
+*
+* Overview: writes the next 'bytes' bytes of a raw burst. With 16-bit
+*			PMP a cycle carries two bytes of the burst, the odd last
+*			byte of a piece is held back and goes out with the first
+*			byte of the next piece. Only the last piece of the burst
+*			ends in a padded cycle.
+*
+********************************************************************/
+void SSD2805RawWrite(const BYTE *pData, DWORD bytes)
+{
+#if defined (USE_16BIT_PMP)
+	if(bytes == 0)
+		return;
+	_rawLeft = (bytes < _rawLeft)? (_rawLeft - bytes) : 0;
+#endif
+	SSD2805TxWait();
+	DisplayEnable();
+	DisplaySetData();
+#if defined (USE_16BIT_PMP)
+	if(_rawHeld)
+	{
+		DeviceWrite(((WORD)pData[0]<<8) | _rawHeldByte);	//lower byte sent first on MIPI link
+		pData++;
+		bytes--;
+		_rawHeld = 0;
+	}
+	if((bytes & 1) && _rawLeft)
+	{
+		_rawHeldByte = pData[--bytes];
+		_rawHeld = 1;
+	}
+#endif
+	SSD2805WriteRaw(pData, bytes);			//releases chip select
+}
+
+/*********************************************************************
+* Function: void SSD2805PushRaw(SHORT left, SHORT top, SHORT right,
+*						SHORT bottom, const BYTE *pData)
+*
+* Overview: writes a rectangle of pixel data in panel byte order as a
+*			single memory write burst
+*
+********************************************************************/
+void SSD2805PushRaw(SHORT left, SHORT top, SHORT right, SHORT bottom, const BYTE *pData)
+{
+	SSD2805RawWrite(pData, SSD2805RawBegin(left, top, right, bottom));
+}
+
+/*********************************************************************
+* Function: BYTE SSD2805QueueBurstEx(SHORT left, SHORT top, SHORT right,
+*						SHORT bottom, const GFX_COLOR *pData, BYTE priority)
+*
+* Overview: queues a rectangle for the next SSD2805PresentFrame().
+*			pData holds (right-left+1)*(bottom-top+1) pixels row by
+*			row and must stay valid until the burst is written.
+*			If pData is NULL the rectangle is filled with the current
+*			color. SSD2805_PRIORITY_LOW bursts may be deferred to a
+*			later frame by the frame scheduler.
+*
+* Input: rectangle borders, inclusive, pixel data or NULL, priority
+*
+* Output: 1 if queued, 0 if the queue is full or the rectangle is empty
+*
+********************************************************************/
+BYTE SSD2805QueueBurstEx(SHORT left, SHORT top, SHORT right, SHORT bottom, const GFX_COLOR *pData, BYTE priority)
+{
+	SSD2805_BURST *pBurst;
+
+	if((_burstCount >= SSD2805_BURST_QUEUE_SIZE) || (left > right) || (top > bottom))
+		return (0);
+
+	pBurst = &_burstQueue[_burstCount++];
+	pBurst->left = left;
+	pBurst->top = top;
+	pBurst->right = right;
+	pBurst->bottom = bottom;
+	pBurst->pData = pData;
+	pBurst->color = _color;
+	pBurst->priority = priority;
+	pBurst->age = 0;
+	return (1);
+}
+
+/*********************************************************************
+* Function: BYTE SSD2805QueueBurst(SHORT left, SHORT top, SHORT right,
+*								SHORT bottom, const GFX_COLOR *pData)
+*
+* Overview: same as SSD2805QueueBurstEx() with SSD2805_PRIORITY_HIGH
+*
+********************************************************************/
+BYTE SSD2805QueueBurst(SHORT left, SHORT top, SHORT right, SHORT bottom, const GFX_COLOR *pData)
+{
+	return (SSD2805QueueBurstEx(left, top, right, bottom, pData, SSD2805_PRIORITY_HIGH));
+}
+
+#ifdef USE_SSD2805_FRAME_SCHEDULER
+#define SSD_FRAME_HIST_BINS		32				//histogram covers 0..2x frame budget
+
+static DWORD	_framePeriod;					//core timer ticks per frame at SSD2805_FRAME_RATE
+static DWORD	_frameBudget;					//ticks of bus work allowed per frame
+static DWORD	_frameStart;					//core timer at start of the last frame
+static DWORD	_ticksPerPixel = 256;			//measured cost of one pixel, Q8 core timer ticks
+static SSD2805_FRAME_STATS	_frameStats;
+static QWORD	_frameTicksSum;
+static WORD		_frameHist[SSD_FRAME_HIST_BINS + 1];	//last bin counts overruns beyond 2x budget
+
+/*********************************************************************
+* Function: static DWORD SSD2805BurstCost(const SSD2805_BURST *pBurst)
+*
+* Overview: predicts the bus time of a burst in core timer ticks from
+*			the measured cost per pixel. Window and TDC setup are
+*			counted as SSD2805_BURST_OVERHEAD_PIXELS extra pixels.
+*
+********************************************************************/
+static DWORD SSD2805BurstCost(const SSD2805_BURST *pBurst)
+{
+	DWORD pixels = (DWORD)(pBurst->right - pBurst->left + 1)*(pBurst->bottom - pBurst->top + 1);
+
+	return (((pixels + SSD2805_BURST_OVERHEAD_PIXELS)*_ticksPerPixel)>>8);
+}
+
+/*********************************************************************
+* Function: static void SSD2805RecordFrame(DWORD ticks)
+*
+* Overview: adds the bus time of one frame to the statistics
+*
+********************************************************************/
+static void SSD2805RecordFrame(DWORD ticks)
+{
+	DWORD us = ticks/TIME_TICKS_PER_US;
+	DWORD bin = ((QWORD)ticks*(SSD_FRAME_HIST_BINS/2))/_frameBudget;
+
+	if(_frameStats.frames == 0 || us < _frameStats.minUs)
+		_frameStats.minUs = us;
+	if(us > _frameStats.maxUs)
+		_frameStats.maxUs = us;
+	if(ticks > _frameBudget)
+		_frameStats.overruns++;
+	_frameStats.frames++;
+	_frameTicksSum += ticks;
+	_frameStats.avgUs = (DWORD)(_frameTicksSum/_frameStats.frames)/TIME_TICKS_PER_US;
+
+	if(bin > SSD_FRAME_HIST_BINS)
+		bin = SSD_FRAME_HIST_BINS;
+	if(_frameHist[bin] != 0xFFFF)
+		_frameHist[bin]++;
+}
+
+/*********************************************************************
+* Function: void SSD2805SchedulerInit(WORD framesPerSecond, BYTE budgetPercent)
+*
+* Overview: sets the target frame rate and the share of each frame
+*			period that may be spent on bus work, clears statistics
+*
+* Input: framesPerSecond - target frame rate, 0 for SSD2805_FRAME_RATE
+*		 budgetPercent - 1..100, 0 for SSD2805_FRAME_BUDGET_PERCENT
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805SchedulerInit(WORD framesPerSecond, BYTE budgetPercent)
+{
+	if(framesPerSecond == 0)
+		framesPerSecond = SSD2805_FRAME_RATE;
+	if((budgetPercent == 0) || (budgetPercent > 100))
+		budgetPercent = SSD2805_FRAME_BUDGET_PERCENT;
+
+	_framePeriod = (GetSystemClock()/2)/framesPerSecond;
+	_frameBudget = (_framePeriod/100)*budgetPercent;
+	_frameStart = TimeGetTicks() - _framePeriod;		//first frame is not delayed
+	SSD2805ResetFrameStats();
+}
+
+/*********************************************************************
+* Function: void SSD2805ResetFrameStats(void)
+*
+* Overview: clears frame time statistics
+*
+********************************************************************/
+void SSD2805ResetFrameStats(void)
+{
+	memset(&_frameStats, 0, sizeof(_frameStats));
+	memset(_frameHist, 0, sizeof(_frameHist));
+	_frameTicksSum = 0;
+}
+
+/*********************************************************************
+* Function: void SSD2805GetFrameStats(SSD2805_FRAME_STATS *pStats)
+*
+* Overview: copies frame time statistics, times are bus work per frame
+*			in microseconds
+*
+********************************************************************/
+void SSD2805GetFrameStats(SSD2805_FRAME_STATS *pStats)
+{
+	*pStats = _frameStats;
+	pStats->budgetUs = _frameBudget/TIME_TICKS_PER_US;
+}
+
+/*********************************************************************
+* Function: DWORD SSD2805GetFrameTimePercentile(BYTE percent)
+*
+* Overview: returns the frame time not exceeded by 'percent' of the
+*			frames, from a histogram with a resolution of 1/16 of the
+*			frame budget. Frames beyond twice the budget are reported
+*			as the maximum frame time.
+*
+* Input: percent - 1..100
+*
+* Output: frame time in microseconds
+*
+********************************************************************/
+DWORD SSD2805GetFrameTimePercentile(BYTE percent)
+{
+	DWORD target, count = 0;
+	WORD bin;
+
+	if(_frameStats.frames == 0)
+		return (0);
+
+	target = ((QWORD)_frameStats.frames*percent + 99)/100;
+	for(bin=0; bin<SSD_FRAME_HIST_BINS; bin++)
+	{
+		count += _frameHist[bin];
+		if(count >= target)
+			return ((((QWORD)_frameBudget*(bin + 1))/(SSD_FRAME_HIST_BINS/2))/TIME_TICKS_PER_US);
+	}
+	return (_frameStats.maxUs);
+}
+#endif	//USE_SSD2805_FRAME_SCHEDULER
+
+/*********************************************************************
+* Function: WORD SSD2805PresentFrame(void)
+*
+* Overview: writes the queued bursts. 
+*
+*			With tearing sync enabled the first burst starts on the
+*			TE edge and bursts are written top to bottom, each one not
+*			before the scan line has reached its top row, so that the
+*			write stays behind the panel read-out. A frame whose bursts
+*			take longer than two frame periods may still tear.
+*
+*			With USE_SSD2805_FRAME_SCHEDULER the frame starts no
+*			earlier than one frame period after the previous one.
+*			High priority bursts are always written; low priority
+*			bursts are written in queue order while the predicted bus
+*			time fits the frame budget, the rest stay queued for the
+*			next frame. A burst deferred SSD2805_MAX_DEFER_FRAMES
+*			times is written regardless.
+*
+* Input: none
+*
+* Output: number of bursts written
+*
+********************************************************************/
+WORD SSD2805PresentFrame(void)
+{
+	SSD2805_BURST temp;
+	WORD i, j, count = _burstCount;
+#ifdef USE_SSD2805_TE_SYNC
+	BYTE synced;
+#endif
+#ifdef USE_SSD2805_FRAME_SCHEDULER
+	SSD2805_BURST deferred[SSD2805_BURST_QUEUE_SIZE];
+	WORD deferredCount = 0;
+	DWORD predicted = 0, busTicks, burstStart;
+	DWORD pixels;
+
+	if(_framePeriod == 0)
+		SSD2805SchedulerInit(0, 0);
+
+	// high priority and overdue bursts first, they are never deferred
+	for(i=0; i<count; i++)
+	{
+		if((_burstQueue[i].priority == SSD2805_PRIORITY_HIGH) || (_burstQueue[i].age >= SSD2805_MAX_DEFER_FRAMES))
+			predicted += SSD2805BurstCost(&_burstQueue[i]);
+	}
+	// low priority bursts while they fit, in queue order
+	for(i=0, j=0; i<count; i++)
+	{
+		if((_burstQueue[i].priority != SSD2805_PRIORITY_HIGH) && (_burstQueue[i].age < SSD2805_MAX_DEFER_FRAMES))
+		{
+			DWORD cost = SSD2805BurstCost(&_burstQueue[i]);
+
+			if(predicted + cost > _frameBudget)
+			{
+				deferred[deferredCount] = _burstQueue[i];
+				deferred[deferredCount++].age++;
+				continue;
+			}
+			predicted += cost;
+		}
+		_burstQueue[j++] = _burstQueue[i];
+	}
+	count = j;
+	_frameStats.deferred += deferredCount;
+
+	while((TimeGetTicks() - _frameStart) < _framePeriod)	//frame pacing
+		TimeYield();
+	_frameStart = TimeGetTicks();
+#endif
+
+	// insertion sort by top row, the queue is short
+	for(i=1; i<count; i++)
+	{
+		temp = _burstQueue[i];
+		for(j=i; (j>0) && (_burstQueue[j-1].top > temp.top); j--)
+			_burstQueue[j] = _burstQueue[j-1];
+		_burstQueue[j] = temp;
+	}
+
+#ifdef USE_SSD2805_TE_SYNC
+	synced = (_teEnable && count)? SSD2805WaitTE() : 0;
+#endif
+#ifdef USE_SSD2805_FRAME_SCHEDULER
+	busTicks = 0;
+	pixels = 0;
+#endif
+	for(i=0; i<count; i++)
+	{
+	#ifdef USE_SSD2805_TE_SYNC
+		if(synced)
+			while(SSD2805GetScanLine() < (WORD)_burstQueue[i].top)
+				TimeYield();
+	#endif
+	#ifdef USE_SSD2805_FRAME_SCHEDULER
+		burstStart = TimeGetTicks();		//scan line waits are not bus time
+	#endif
+		SSD2805WriteBurst(&_burstQueue[i]);
+	#ifdef USE_SSD2805_FRAME_SCHEDULER
+		SSD2805TxWait();					//interrupt transfers are bus time as well
+		busTicks += TimeGetTicks() - burstStart;
+		pixels += (DWORD)(_burstQueue[i].right - _burstQueue[i].left + 1)*(_burstQueue[i].bottom - _burstQueue[i].top + 1)
+					+ SSD2805_BURST_OVERHEAD_PIXELS;
+	#endif
+	}
+
+#ifdef USE_SSD2805_FRAME_SCHEDULER
+	if(count)
+	{
+		// cost per pixel as running average, new frame weighted 1/4
+		LONG ticksPerPixel = (LONG)(((QWORD)busTicks<<8)/pixels);
+
+		_ticksPerPixel += (ticksPerPixel - (LONG)_ticksPerPixel)/4;
+		SSD2805RecordFrame(busTicks);
+	}
+#endif
+
+	_burstCount = 0;
+#ifdef USE_SSD2805_FRAME_SCHEDULER
+	// deferred bursts stay queued for the next frame
+	for(i=0; i<deferredCount; i++)
+		_burstQueue[_burstCount++] = deferred[i];
+#endif
+	return (count);
+}
+#endif	//USE_SSD2805_CMD_MODE
+
+// two RGB565 pixels stored as one 32-bit word, DWORD is 64 bits wide on the host build
+#define SSD_PIXEL_PAIR(p)		(*(unsigned int *)(p))
+
+// 4x4 Bayer matrix, thresholds 0..15
+static const BYTE _bayer4x4[4][4] =
+{
+	{ 0,  8,  2, 10},
+	{12,  4, 14,  6},
+	{ 3, 11,  1,  9},
+	{15,  7, 13,  5}
+};
+
+/*********************************************************************
+* Function: static DWORD SSD2805Pack565x2(DWORD r, DWORD g, DWORD b, DWORD d5, DWORD d6)
+*
+* Overview: packs two pixels to RGB565, pixel 0 in the low half word.
+*			Each channel holds pixel 0 in bits 7:0 and pixel 1 in bits
+*			23:16, d5/d6 are the dither thresholds laid out the same
+*			way for the 5-bit and 6-bit channels. A carry into bit 8
+*			of a lane saturates that lane to 0xFF.
+*
+********************************************************************/
+static inline DWORD SSD2805Pack565x2(DWORD r, DWORD g, DWORD b, DWORD d5, DWORD d6)
+{
+	DWORD c;
+
+	r += d5;
+	c = r & 0x01000100ul;
+	r = (r | (c - (c >> 8))) & 0x00FF00FFul;
+	g += d6;
+	c = g & 0x01000100ul;
+	g = (g | (c - (c >> 8))) & 0x00FF00FFul;
+	b += d5;
+	c = b & 0x01000100ul;
+	b = (b | (c - (c >> 8))) & 0x00FF00FFul;
+
+	return (((r & 0x00F800F8ul) << 8) | ((g & 0x00FC00FCul) << 3) | ((b & 0x00F800F8ul) >> 3));
+}
+
+#ifdef SSD_USE_SSE2
+/*********************************************************************
+* Function: static void SSD2805Convert888SSE2(WORD *pDst, const BYTE *pSrc,
+*						WORD count, const BYTE *pT5, const BYTE *pT6)
+*
+* Overview: converts count / 16 runs of 16 RGB888 pixels to RGB565 and
+*			returns the pixels done. pT5/pT6 hold the 5-bit and 6-bit
+*			channel thresholds of 16 pixels. The saturating byte add
+*			gives the same result as the carry saturation of
+*			SSD2805Pack565x2().
+*
+********************************************************************/
+static WORD SSD2805Convert888SSE2(WORD *pDst, const BYTE *pSrc, WORD count, const BYTE *pT5, const BYTE *pT6)
+{
+	const __m128i t5 = _mm_loadu_si128((const __m128i *)pT5);
+	const __m128i t6 = _mm_loadu_si128((const __m128i *)pT6);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i mask5 = _mm_set1_epi8((char)0xF8);
+	const __m128i mask6 = _mm_set1_epi8((char)0xFC);
+	__m128i a0, a1, a2, b0, b1, b2, r, g, b;
+	WORD done;
+
+	for(done = 0; count - done >= 16; done += 16)
+	{
+		a0 = _mm_loadu_si128((const __m128i *)pSrc);
+		a1 = _mm_loadu_si128((const __m128i *)(pSrc + 16));
+		a2 = _mm_loadu_si128((const __m128i *)(pSrc + 32));
+		pSrc += 48;
+
+		// each pass interleaves the bytes of the thirds of the 48 bytes,
+		// after four passes R, G and B are in a0, a1 and a2
+		b0 = _mm_unpacklo_epi8(a0, _mm_unpackhi_epi64(a1, a1));
+		b1 = _mm_unpacklo_epi8(_mm_unpackhi_epi64(a0, a0), a2);
+		b2 = _mm_unpacklo_epi8(a1, _mm_unpackhi_epi64(a2, a2));
+		a0 = _mm_unpacklo_epi8(b0, _mm_unpackhi_epi64(b1, b1));
+		a1 = _mm_unpacklo_epi8(_mm_unpackhi_epi64(b0, b0), b2);
+		a2 = _mm_unpacklo_epi8(b1, _mm_unpackhi_epi64(b2, b2));
+		b0 = _mm_unpacklo_epi8(a0, _mm_unpackhi_epi64(a1, a1));
+		b1 = _mm_unpacklo_epi8(_mm_unpackhi_epi64(a0, a0), a2);
+		b2 = _mm_unpacklo_epi8(a1, _mm_unpackhi_epi64(a2, a2));
+		a0 = _mm_unpacklo_epi8(b0, _mm_unpackhi_epi64(b1, b1));
+		a1 = _mm_unpacklo_epi8(_mm_unpackhi_epi64(b0, b0), b2);
+		a2 = _mm_unpacklo_epi8(b1, _mm_unpackhi_epi64(b2, b2));
+
+		r = _mm_and_si128(_mm_adds_epu8(a0, t5), mask5);
+		g = _mm_and_si128(_mm_adds_epu8(a1, t6), mask6);
+		b = _mm_srli_epi16(_mm_and_si128(_mm_adds_epu8(a2, t5), mask5), 3);	// no bits cross a byte
+
+		_mm_storeu_si128((__m128i *)pDst, _mm_or_si128(_mm_or_si128(_mm_unpacklo_epi8(zero, r),
+						 _mm_slli_epi16(_mm_unpacklo_epi8(g, zero), 3)), _mm_unpacklo_epi8(b, zero)));
+		_mm_storeu_si128((__m128i *)(pDst + 8), _mm_or_si128(_mm_or_si128(_mm_unpackhi_epi8(zero, r),
+						 _mm_slli_epi16(_mm_unpackhi_epi8(g, zero), 3)), _mm_unpackhi_epi8(b, zero)));
+		pDst += 16;
+	}
+	return (done);
+}
+#endif
+
+/*********************************************************************
+* Function: void SSD2805ConvertRow888(WORD *pDst, const BYTE *pSrc,
+*						WORD count, SHORT x, SHORT y, BYTE dither)
+*
+* Overview: converts a row of RGB888 pixels to RGB565, two pixels per
+*			32-bit word, with optional 4x4 ordered dithering. The host
+*			build does runs of 16 pixels with SSE2 first.
+*
+********************************************************************/
+void SSD2805ConvertRow888(WORD *pDst, const BYTE *pSrc, WORD count, SHORT x, SHORT y, BYTE dither)
+{
+	const BYTE *pRow = _bayer4x4[y & 3];
+	DWORD d5[2], d6[2];		// thresholds of the pairs at x phase 0-1 / 2-3 of the current run
+	BYTE phase = x & 3;
+	BYTE i;
+#ifdef SSD_USE_SSE2
+	BYTE t5[16], t6[16];
+	WORD done;
+#endif
+
+	// a single pixel first when pDst is not word aligned
+	if(count && ((DWORD)pDst & 0x02))
+	{
+		if(dither)
+			*pDst = (WORD)SSD2805Pack565x2(pSrc[0], pSrc[1], pSrc[2], pRow[phase] >> 1, pRow[phase] >> 2);
+		else
+			*pDst = (WORD)SSD2805Pack565x2(pSrc[0], pSrc[1], pSrc[2], 0, 0);
+		pDst++;
+		pSrc += 3;
+		count--;
+		phase = (phase + 1) & 3;
+	}
+
+#ifdef SSD_USE_SSE2
+	// 16 pixels are 4 periods of the Bayer row, the phase stays the same
+	for(i=0; i<16; i++)
+	{
+		t5[i] = dither ? pRow[(phase + i) & 3] >> 1 : 0;
+		t6[i] = dither ? pRow[(phase + i) & 3] >> 2 : 0;
+	}
+	done = SSD2805Convert888SSE2(pDst, pSrc, count, t5, t6);
+	pDst += done;
+	pSrc += 3 * done;
+	count -= done;
+#endif
+
+	// pairs advance 2 pixels, their thresholds alternate between two values
+	for(i=0; i<2; i++)
+	{
+		if(dither)
+		{
+			// a 5-bit channel drops 3 bits, threshold 0..7, a 6-bit channel drops 2 bits, 0..3
+			d5[i] = (pRow[(phase + 2*i) & 3] >> 1) | ((DWORD)(pRow[(phase + 2*i + 1) & 3] >> 1) << 16);
+			d6[i] = (pRow[(phase + 2*i) & 3] >> 2) | ((DWORD)(pRow[(phase + 2*i + 1) & 3] >> 2) << 16);
+		}
+		else
+		{
+			d5[i] = 0;
+			d6[i] = 0;
+		}
+	}
+
+	i = 0;
+	while(count >= 2)
+	{
+		SSD_PIXEL_PAIR(pDst) = SSD2805Pack565x2(pSrc[0] | ((DWORD)pSrc[3] << 16),
+										  pSrc[1] | ((DWORD)pSrc[4] << 16),
+										  pSrc[2] | ((DWORD)pSrc[5] << 16),
+										  d5[i], d6[i]);	//little endian, first pixel in the low half word
+		pDst += 2;
+		pSrc += 6;
+		count -= 2;
+		i ^= 1;
+	}
+
+	if(count)
+		*pDst = (WORD)SSD2805Pack565x2(pSrc[0], pSrc[1], pSrc[2], d5[i] & 0xFF, d6[i] & 0xFF);
+}
+
+// 0..255 alpha to the 0..32 weight used by the blend kernels
+#define SSD_ALPHA32(alpha)		(((WORD)(alpha) + 4) >> 3)
+
+// two RGB565 pixels p0 | (p1 << 16) split into two words with room for
+// a 0..32 weight above each field: R0 B0 G1 with 0x07E0F81F, and after
+// a 5-bit shift G0 B1 R1 with 0x07C0F83F
+#define SSD_SPLIT_A				0x07E0F81Ful
+#define SSD_SPLIT_B				0x07C0F83Ful
+
+/*********************************************************************
+* Function: WORD SSD2805Blend565(WORD fg, WORD bg, BYTE alpha)
+*
+* Overview: blends one RGB565 pixel over another, the three channels
+*			are spread over one 32-bit word and weighted by a single
+*			multiply
+*
+********************************************************************/
+WORD SSD2805Blend565(WORD fg, WORD bg, BYTE alpha)
+{
+	DWORD f, b;
+	BYTE a = SSD_ALPHA32(alpha);
+
+	f = (fg | ((DWORD)fg << 16)) & SSD_SPLIT_A;
+	b = (bg | ((DWORD)bg << 16)) & SSD_SPLIT_A;
+	b = ((f * a + b * (32 - a)) >> 5) & SSD_SPLIT_A;
+
+	return ((WORD)(b | (b >> 16)));
+}
+
+/*********************************************************************
+* Function: static DWORD SSD2805Blend565x2(DWORD fa, DWORD fb, DWORD bg, BYTE a)
+*
+* Overview: blends a pair of background pixels with a foreground pair
+*			already split and weighted, fa = split A * a and fb =
+*			split B * a, a is the 0..32 weight of the foreground
+*
+********************************************************************/
+static inline DWORD SSD2805Blend565x2(DWORD fa, DWORD fb, DWORD bg, BYTE a)
+{
+	DWORD ba, bb;
+
+	ba = ((fa + (bg & SSD_SPLIT_A) * (32 - a)) >> 5) & SSD_SPLIT_A;
+	bb = ((fb + ((bg >> 5) & SSD_SPLIT_B) * (32 - a)) >> 5) & SSD_SPLIT_B;
+
+	return (ba | (bb << 5));
+}
+
+/*********************************************************************
+* Function: void SSD2805FillRowAlpha(WORD *pDst, WORD color, WORD count, BYTE alpha)
+*
+* Overview: blends a constant color over a row of RGB565 pixels, two
+*			pixels per 32-bit word
+*
+********************************************************************/
+void SSD2805FillRowAlpha(WORD *pDst, WORD color, WORD count, BYTE alpha)
+{
+	DWORD pair = color | ((DWORD)color << 16);
+	DWORD fa, fb;
+	BYTE a = SSD_ALPHA32(alpha);
+
+	if(a == 0)
+		return;
+	fa = (pair & SSD_SPLIT_A) * a;
+	fb = ((pair >> 5) & SSD_SPLIT_B) * a;
+
+	if(count && ((DWORD)pDst & 0x02))
+	{
+		*pDst = (WORD)SSD2805Blend565x2(fa, fb, *pDst, a);
+		pDst++;
+		count--;
+	}
+	while(count >= 2)
+	{
+		SSD_PIXEL_PAIR(pDst) = SSD2805Blend565x2(fa, fb, SSD_PIXEL_PAIR(pDst), a);
+		pDst += 2;
+		count -= 2;
+	}
+	if(count)
+		*pDst = (WORD)SSD2805Blend565x2(fa, fb, *pDst, a);
+}
+
+/*********************************************************************
+* Function: void SSD2805BlendRow(WORD *pDst, const WORD *pSrc, WORD count, BYTE alpha)
+*
+* Overview: blends a row of RGB565 pixels over another with constant
+*			alpha, two pixels per 32-bit word
+*
+********************************************************************/
+void SSD2805BlendRow(WORD *pDst, const WORD *pSrc, WORD count, BYTE alpha)
+{
+	DWORD pair;
+	BYTE a = SSD_ALPHA32(alpha);
+
+	if(a == 0)
+		return;
+
+	if(count && ((DWORD)pDst & 0x02))
+	{
+		*pDst = SSD2805Blend565(*pSrc++, *pDst, alpha);
+		pDst++;
+		count--;
+	}
+	while(count >= 2)
+	{
+		pair = pSrc[0] | ((DWORD)pSrc[1] << 16);	// pSrc may not be word aligned
+		SSD_PIXEL_PAIR(pDst) = SSD2805Blend565x2((pair & SSD_SPLIT_A) * a, ((pair >> 5) & SSD_SPLIT_B) * a, SSD_PIXEL_PAIR(pDst), a);
+		pDst += 2;
+		pSrc += 2;
+		count -= 2;
+	}
+	if(count)
+		*pDst = SSD2805Blend565(*pSrc, *pDst, alpha);
+}
+
+/*********************************************************************
+* Function: void SSD2805BlendRowA8(WORD *pDst, WORD color, const BYTE *pMask, WORD count)
+*
+* Overview: blends a constant color over a row of RGB565 pixels through
+*			an 8-bit alpha mask, e.g. anti-aliased glyphs
+*
+********************************************************************/
+void SSD2805BlendRowA8(WORD *pDst, WORD color, const BYTE *pMask, WORD count)
+{
+	DWORD f = (color | ((DWORD)color << 16)) & SSD_SPLIT_A;
+	DWORD b;
+	BYTE a;
+
+	while(count--)
+	{
+		a = SSD_ALPHA32(*pMask++);
+		if(a == 32)
+		{
+			*pDst = color;
+		}
+		else if(a)
+		{
+			b = (*pDst | ((DWORD)*pDst << 16)) & SSD_SPLIT_A;
+			b = ((f * a + b * (32 - a)) >> 5) & SSD_SPLIT_A;
+			*pDst = (WORD)(b | (b >> 16));
+		}
+		pDst++;
+	}
+}
+
+/*********************************************************************
+* Function: void SSD2805BlendRowARGB4444(WORD *pDst, const WORD *pSrc, WORD count)
+*
+* Overview: blends a row of ARGB4444 pixels over a row of RGB565 pixels
+*
+********************************************************************/
+void SSD2805BlendRowARGB4444(WORD *pDst, const WORD *pSrc, WORD count)
+{
+	WORD argb, fg;
+	BYTE a;
+
+	while(count--)
+	{
+		argb = *pSrc++;
+		a = argb >> 12;
+		if(a)
+		{
+			// 4-bit channels to 5/6/5 bits, the top bits are repeated
+			fg = ((argb & 0x0F00) << 4) | (argb & 0x0800) |
+				 ((argb & 0x00F0) << 3) | ((argb & 0x00C0) >> 1) |
+				 ((argb & 0x000F) << 1) | ((argb & 0x0008) >> 3);
+			*pDst = (a == 0x0F)? fg : SSD2805Blend565(fg, *pDst, a * 17);
+		}
+		pDst++;
+	}
+}
+
+#ifdef USE_SSD2805_CMD_MODE
+// a run of n pixels streamed on its own must end on a whole PMP cycle,
+// see SSD2805WritePixels()
+#define SSD_WHOLE_CYCLES(n)		((SSD_BUS_BYTES == 1) || (_pixelBytes == 2) || !((n) & 1))
+
+/*********************************************************************
+* Function: static GFX_COLOR SSD2805GradientColor(const LONG *pValue,
+*						BYTE threshold, BYTE shift5, BYTE shift6)
+*
+* Overview: color of a gradient pixel from the 8.16 fixed point R, G, B
+*			values, with the dither threshold scaled down to the bits
+*			each channel loses. A shift of 8 or more disables dither.
+*
+********************************************************************/
+static inline GFX_COLOR SSD2805GradientColor(const LONG *pValue, BYTE threshold, BYTE shift5, BYTE shift6)
+{
+	WORD r = (WORD)(pValue[0] >> 16) + (threshold >> shift5);
+	WORD g = (WORD)(pValue[1] >> 16) + (threshold >> shift6);
+	WORD b = (WORD)(pValue[2] >> 16) + (threshold >> shift5);
+
+	if(r > 0xFF)
+		r = 0xFF;
+	if(g > 0xFF)
+		g = 0xFF;
+	if(b > 0xFF)
+		b = 0xFF;
+#if (COLOR_DEPTH == 24)
+	return (((DWORD)r << 16) | (g << 8) | b);
+#else
+	return (((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+#endif
+}
+
+/*********************************************************************
+* Function: void SSD2805FillGradient(SHORT left, SHORT top, SHORT right,
+*						SHORT bottom, GFX_COLOR startColor,
+*						GFX_COLOR endColor, BYTE direction, BYTE dither)
+*
+* Overview: fills a rectangle with a linear gradient in one memory
+*			write burst. Colors are stepped with 8.16 fixed point per
+*			channel and streamed from two span buffers, one is filled
+*			while the other is sent. Undithered vertical gradients
+*			send one solid run per row.
+*
+********************************************************************/
+void SSD2805FillGradient(SHORT left, SHORT top, SHORT right, SHORT bottom, GFX_COLOR startColor, GFX_COLOR endColor, BYTE direction, BYTE dither)
+{
+	GFX_COLOR	span[2][SSD2805_GRADIENT_SPAN];
+	LONG		value[3], rowValue[3], step[3];
+	DWORD		c0, c1;
+	WORD		width, steps;
+	SHORT		x, y;
+	BYTE		shift5, shift6, threshold, solid;
+	BYTE		i, buf = 0, n = 0;
+
+	if((left > right) || (top > bottom))
+		return;
+
+	width = right - left + 1;
+	if(direction == SSD2805_GRADIENT_HORIZONTAL)
+		steps = width - 1;
+	else if(direction == SSD2805_GRADIENT_VERTICAL)
+		steps = bottom - top;
+	else
+		steps = width - 1 + bottom - top;
+
+#if (COLOR_DEPTH == 24)
+	c0 = startColor;
+	c1 = endColor;
+#else
+	c0 = SSD2805Rgb565To888(startColor);
+	c1 = SSD2805Rgb565To888(endColor);
+#endif
+	for(i=0; i<3; i++)
+	{
+		rowValue[i] = ((LONG)((c0 >> (16 - 8*i)) & 0xFF) << 16) + 0x8000;
+		step[i] = (((LONG)((c1 >> (16 - 8*i)) & 0xFF) << 16) - (rowValue[i] - 0x8000));
+		step[i] = (steps)? (step[i] / steps) : 0;
+	}
+
+	// Bayer thresholds 0..15 scaled to the 3 or 2 bits a channel loses
+	shift5 = 8;
+	shift6 = 8;
+	if(dither)
+	{
+		if((COLOR_DEPTH == 16) || (_pixelBytes == 2))
+		{
+			shift5 = 1;
+			shift6 = 2;
+		}
+		else if(_pixelFormat == SSD2805_PIXEL_FORMAT_18)
+		{
+			shift5 = 2;
+			shift6 = 2;
+		}
+	}
+
+	solid = (direction == SSD2805_GRADIENT_VERTICAL) && (shift5 == 8) && SSD_WHOLE_CYCLES(width);
+
+	SSD2805BeginBurst(left, top, right, bottom);
+	for(y=top; y<=bottom; y++)
+	{
+		for(i=0; i<3; i++)
+			value[i] = rowValue[i];
+
+		if(solid)
+		{
+			SSD2805StreamPixels(NULL, SSD2805GradientColor(value, 0, 8, 8), width);
+		}
+		else
+		{
+			for(x=left; x<=right; x++)
+			{
+				threshold = _bayer4x4[y & 3][x & 3];
+				span[buf][n++] = SSD2805GradientColor(value, threshold, shift5, shift6);
+				if(direction != SSD2805_GRADIENT_VERTICAL)
+				{
+					value[0] += step[0];
+					value[1] += step[1];
+					value[2] += step[2];
+				}
+				if(n == SSD2805_GRADIENT_SPAN)
+				{
+					SSD2805StreamPixels(span[buf], 0, n);	//waits for the other buffer to be sent
+					buf ^= 1;
+					n = 0;
+				}
+			}
+		}
+
+		if(direction != SSD2805_GRADIENT_HORIZONTAL)
+		{
+			rowValue[0] += step[0];
+			rowValue[1] += step[1];
+			rowValue[2] += step[2];
+		}
+	}
+	if(n)
+		SSD2805StreamPixels(span[buf], 0, n);
+	SSD2805TxWait();						//span buffers are on the stack
+}
+
+typedef struct
+{
+	SHORT	left;
+	SHORT	top;
+	SHORT	right;
+	SHORT	bottom;
+} SSD_RECT;
+
+/*********************************************************************
+* Function: static BYTE SSD2805RectSubtract(const SSD_RECT *pA,
+*						const SSD_RECT *pB, SSD_RECT *pOut)
+*
+* Overview: splits the part of A outside B into up to four rectangles,
+*			full width bands above and below B, then the parts left
+*			and right of B
+*
+* Output: number of rectangles in pOut
+*
+********************************************************************/
+static BYTE SSD2805RectSubtract(const SSD_RECT *pA, const SSD_RECT *pB, SSD_RECT *pOut)
+{
+	SSD_RECT mid;
+	BYTE n = 0;
+
+	if((pB->left > pA->right) || (pB->right < pA->left) || (pB->top > pA->bottom) || (pB->bottom < pA->top))
+	{
+		pOut[0] = *pA;
+		return (1);
+	}
+
+	mid = *pA;
+	if(pB->top > pA->top)
+	{
+		pOut[n] = *pA;
+		pOut[n++].bottom = pB->top - 1;
+		mid.top = pB->top;
+	}
+	if(pB->bottom < pA->bottom)
+	{
+		pOut[n] = *pA;
+		pOut[n++].top = pB->bottom + 1;
+		mid.bottom = pB->bottom;
+	}
+	if(pB->left > pA->left)
+	{
+		pOut[n] = mid;
+		pOut[n++].right = pB->left - 1;
+	}
+	if(pB->right < pA->right)
+	{
+		pOut[n] = mid;
+		pOut[n++].left = pB->right + 1;
+	}
+	return (n);
+}
+
+/*********************************************************************
+* Function: static void SSD2805WriteRect(const SSD_RECT *pRect,
+*						const GFX_COLOR *pBuf, const SSD_RECT *pBufRect)
+*
+* Overview: writes the part pRect of a pixel buffer that covers
+*			pBufRect. Rows are streamed into one windowed burst, or
+*			a burst per row if a row does not end on a whole PMP cycle.
+*
+********************************************************************/
+static void SSD2805WriteRect(const SSD_RECT *pRect, const GFX_COLOR *pBuf, const SSD_RECT *pBufRect)
+{
+	WORD width = pRect->right - pRect->left + 1;
+	WORD stride = pBufRect->right - pBufRect->left + 1;
+	SHORT y;
+
+	pBuf += (pRect->top - pBufRect->top)*stride + (pRect->left - pBufRect->left);
+	if(SSD_WHOLE_CYCLES(width))
+	{
+		SSD2805BeginBurst(pRect->left, pRect->top, pRect->right, pRect->bottom);
+		for(y=pRect->top; y<=pRect->bottom; y++, pBuf += stride)
+			SSD2805StreamPixels(pBuf, 0, width);
+	}
+	else
+	{
+		for(y=pRect->top; y<=pRect->bottom; y++, pBuf += stride)
+		{
+			SSD2805BeginBurst(pRect->left, y, pRect->right, y);
+			SSD2805StreamPixels(pBuf, 0, width);
+		}
+	}
+}
+
+/*********************************************************************
+* Function: static void SSD2805ReadRect(SHORT left, SHORT top, SHORT right,
+*						SHORT bottom, GFX_COLOR *pDst, WORD stride)
+*
+* Overview: reads a rectangle back from GRAM, the default background
+*			source of a sprite. The window is set once, the pixels are
+*			read in SSD2805_READ_CHUNK_BYTES pieces, 0x2E first and
+*			0x3E for the rest. Reading stops at the first failed read,
+*			the pixels not read are left as they are.
+*
+********************************************************************/
+static void SSD2805ReadRect(SHORT left, SHORT top, SHORT right, SHORT bottom, GFX_COLOR *pDst, WORD stride)
+{
+	GFX_COLOR chunk[SSD2805_READ_CHUNK_BYTES/2];
+	WORD width = right - left + 1;
+	WORD maxCount = SSD2805_READ_CHUNK_BYTES/_pixelBytes;
+	DWORD remaining = (DWORD)width*(bottom - top + 1);
+	WORD count, i, x = 0;
+	BYTE cmd = 0x2E;						//memory read start, then continue
+
+	SSD2805SetWindow(left, top, right, bottom);
+	while(remaining)
+	{
+		count = (remaining > maxCount)? maxCount : (WORD)remaining;
+		if(SSD2805ReadPixels(cmd, chunk, count) != SSD2805_READ_OK)
+			return;
+		cmd = 0x3E;
+		for(i=0; i<count; i++)				//window is read row by row
+		{
+			pDst[x] = chunk[i];
+			if(++x == width)
+			{
+				x = 0;
+				pDst += stride;
+			}
+		}
+		remaining -= count;
+	}
+}
+
+/*********************************************************************
+* Function: static void SSD2805SpriteCapture(SSD2805_SPRITE *pSprite,
+*						const SSD_RECT *pNew, const SSD_RECT *pOld)
+*
+* Overview: builds the save-under of the sprite at pNew in pWork, the
+*			part inside pOld is copied from pSave, the rest is taken
+*			from the background source. pOld is NULL if the sprite is
+*			not on screen.
+*
+********************************************************************/
+static void SSD2805SpriteCapture(SSD2805_SPRITE *pSprite, const SSD_RECT *pNew, const SSD_RECT *pOld)
+{
+	SSD2805_BACKGROUND_FUNC getBackground = (pSprite->getBackground)? pSprite->getBackground : SSD2805ReadRect;
+	SSD_RECT fetch[4], overlap;
+	GFX_COLOR *pDst;
+	const GFX_COLOR *pSrc;
+	SHORT x, y;
+	BYTE i, n;
+
+	if(pOld)
+	{
+		n = SSD2805RectSubtract(pNew, pOld, fetch);
+
+		// background already saved, copy it over row by row
+		overlap.left = (pNew->left > pOld->left)? pNew->left : pOld->left;
+		overlap.right = (pNew->right < pOld->right)? pNew->right : pOld->right;
+		overlap.top = (pNew->top > pOld->top)? pNew->top : pOld->top;
+		overlap.bottom = (pNew->bottom < pOld->bottom)? pNew->bottom : pOld->bottom;
+		if((overlap.left <= overlap.right) && (overlap.top <= overlap.bottom))
+		{
+			pDst = pSprite->pWork + (overlap.top - pNew->top)*pSprite->width + (overlap.left - pNew->left);
+			pSrc = pSprite->pSave + (overlap.top - pOld->top)*pSprite->width + (overlap.left - pOld->left);
+			for(y=overlap.top; y<=overlap.bottom; y++)
+			{
+				for(x=0; x<=overlap.right - overlap.left; x++)
+					pDst[x] = pSrc[x];
+				pDst += pSprite->width;
+				pSrc += pSprite->width;
+			}
+		}
+	}
+	else
+	{
+		fetch[0] = *pNew;
+		n = 1;
+	}
+
+	for(i=0; i<n; i++)
+	{
+		getBackground(fetch[i].left, fetch[i].top, fetch[i].right, fetch[i].bottom,
+					  pSprite->pWork + (fetch[i].top - pNew->top)*pSprite->width + (fetch[i].left - pNew->left),
+					  pSprite->width);
+	}
+}
+
+/*********************************************************************
+* Function: static void SSD2805SpriteDraw(SSD2805_SPRITE *pSprite, const SSD_RECT *pRect)
+*
+* Overview: makes pWork the save-under, composes the sprite over it in
+*			the old save-under buffer and writes it as one burst
+*
+********************************************************************/
+static void SSD2805SpriteDraw(SSD2805_SPRITE *pSprite, const SSD_RECT *pRect)
+{
+	GFX_COLOR *pSave = pSprite->pWork;
+	GFX_COLOR *pOut = pSprite->pSave;
+	const GFX_COLOR *pImage = pSprite->pImage;
+	WORD i, count = pSprite->width*pSprite->height;
+
+	pSprite->pSave = pSave;
+	pSprite->pWork = pOut;
+	for(i=0; i<count; i++)
+	{
+		pOut[i] = (pSprite->useKey && (pImage[i] == pSprite->keyColor))? pSave[i] : pImage[i];
+	}
+	SSD2805WriteRect(pRect, pOut, pRect);
+
+	pSprite->x = pRect->left;
+	pSprite->y = pRect->top;
+	pSprite->visible = 1;
+}
+
+/*********************************************************************
+* Function: static void SSD2805SpriteRect(const SSD2805_SPRITE *pSprite,
+*						SHORT x, SHORT y, SSD_RECT *pRect)
+*
+* Overview: sprite rectangle at (x, y), moved inside the screen
+*
+********************************************************************/
+static void SSD2805SpriteRect(const SSD2805_SPRITE *pSprite, SHORT x, SHORT y, SSD_RECT *pRect)
+{
+	if(x > GetMaxX() + 1 - (SHORT)pSprite->width)
+		x = GetMaxX() + 1 - pSprite->width;
+	if(y > GetMaxY() + 1 - (SHORT)pSprite->height)
+		y = GetMaxY() + 1 - pSprite->height;
+	if(x < 0)
+		x = 0;
+	if(y < 0)
+		y = 0;
+	pRect->left = x;
+	pRect->top = y;
+	pRect->right = x + pSprite->width - 1;
+	pRect->bottom = y + pSprite->height - 1;
+}
+
+/*********************************************************************
+* Function: void SSD2805SpriteInit(SSD2805_SPRITE *pSprite, const GFX_COLOR *pImage,
+*						WORD width, WORD height, GFX_COLOR *pBuffer,
+*						SSD2805_BACKGROUND_FUNC getBackground)
+*
+* Overview: sets up a hidden sprite
+*
+********************************************************************/
+void SSD2805SpriteInit(SSD2805_SPRITE *pSprite, const GFX_COLOR *pImage, WORD width, WORD height, GFX_COLOR *pBuffer, SSD2805_BACKGROUND_FUNC getBackground)
+{
+	pSprite->pImage = pImage;
+	pSprite->width = width;
+	pSprite->height = height;
+	pSprite->pSave = pBuffer;
+	pSprite->pWork = pBuffer + (WORD)(width*height);
+	pSprite->getBackground = getBackground;
+	pSprite->useKey = 0;
+	pSprite->keyColor = 0;
+	pSprite->visible = 0;
+	pSprite->x = 0;
+	pSprite->y = 0;
+}
+
+/*********************************************************************
+* Function: void SSD2805SpriteMove(SSD2805_SPRITE *pSprite, SHORT x, SHORT y)
+*
+* Overview: shows the sprite at (x, y). The background exposed by the
+*			move is restored from the save-under, the sprite is then
+*			written over its new rectangle, each as a windowed burst.
+*
+********************************************************************/
+void SSD2805SpriteMove(SSD2805_SPRITE *pSprite, SHORT x, SHORT y)
+{
+	SSD_RECT old, rect, exposed[4];
+	BYTE i, n;
+
+	SSD2805TxWait();						//buffers may still be sent from the last move
+	SSD2805SpriteRect(pSprite, x, y, &rect);
+	if(!pSprite->visible)
+	{
+		SSD2805SpriteCapture(pSprite, &rect, NULL);
+		SSD2805SpriteDraw(pSprite, &rect);
+		return;
+	}
+
+	old.left = pSprite->x;
+	old.top = pSprite->y;
+	old.right = old.left + pSprite->width - 1;
+	old.bottom = old.top + pSprite->height - 1;
+
+	SSD2805SpriteCapture(pSprite, &rect, &old);
+	if((rect.left != old.left) || (rect.top != old.top))
+	{
+		n = SSD2805RectSubtract(&old, &rect, exposed);
+		for(i=0; i<n; i++)
+			SSD2805WriteRect(&exposed[i], pSprite->pSave, &old);
+	}
+	SSD2805TxWait();						//pSave is written over next
+	SSD2805SpriteDraw(pSprite, &rect);
+}
+
+/*********************************************************************
+* Function: void SSD2805SpriteHide(SSD2805_SPRITE *pSprite)
+*
+* Overview: restores the background under the sprite
+*
+********************************************************************/
+void SSD2805SpriteHide(SSD2805_SPRITE *pSprite)
+{
+	SSD_RECT rect;
+
+	if(!pSprite->visible)
+		return;
+
+	SSD2805TxWait();
+	rect.left = pSprite->x;
+	rect.top = pSprite->y;
+	rect.right = rect.left + pSprite->width - 1;
+	rect.bottom = rect.top + pSprite->height - 1;
+	SSD2805WriteRect(&rect, pSprite->pSave, &rect);
+	pSprite->visible = 0;
+}
+#endif	//USE_SSD2805_CMD_MODE
+
+#ifdef USE_SSD2805_PERF_COUNTERS
+/*********************************************************************
+* Function: void SSD2805GetPerfCounters(SSD2805_PERF_COUNTERS *pCounters)
+*
+* Overview: copies the counters, avgBurstBytes is computed here
+*
+********************************************************************/
+void SSD2805GetPerfCounters(SSD2805_PERF_COUNTERS *pCounters)
+{
+	*pCounters = _perf;
+	pCounters->busyWaitTicks = _ssd2805BusyTicks;
+	pCounters->avgBurstBytes = (_perf.bursts)? (_perf.burstBytes/_perf.bursts) : 0;
+}
+
+/*********************************************************************
+* Function: void SSD2805ResetPerfCounters(void)
+*
+* Overview: clears the counters
+*
+********************************************************************/
+void SSD2805ResetPerfCounters(void)
+{
+	memset(&_perf, 0, sizeof(_perf));
+	_ssd2805BusyTicks = 0;
+}
+#endif //USE_SSD2805_PERF_COUNTERS
+
+#ifdef USE_SSD2805_TRACE
+/*********************************************************************
+* Function: WORD SSD2805TraceSnapshot(SSD2805_TRACE_ENTRY *pBuf, WORD max)
+*
+* Overview: copies up to 'max' of the most recent entries, oldest first
+*
+* Output: number of entries copied
+*
+********************************************************************/
+WORD SSD2805TraceSnapshot(SSD2805_TRACE_ENTRY *pBuf, WORD max)
+{
+	DWORD count = _traceCount;
+	DWORD first;
+	WORD n;
+
+	n = (count > SSD2805_TRACE_SIZE)? SSD2805_TRACE_SIZE : (WORD)count;
+	if(n > max)
+		n = max;
+	for(first = count - n; first != count; first++)
+		*pBuf++ = _trace[first & (SSD2805_TRACE_SIZE - 1)];
+	return (n);
+}
+
+/*********************************************************************
+* Function: static void SSD2805TracePutHex(void (*putChar)(char c), DWORD value, BYTE digits)
+*
+* Overview: prints 'value' as 'digits' hex digits
+*
+********************************************************************/
+static void SSD2805TracePutHex(void (*putChar)(char c), DWORD value, BYTE digits)
+{
+	static const char hex[] = "0123456789ABCDEF";
+
+	while(digits--)
+		putChar(hex[(value >> (digits*4)) & 0x0F]);
+}
+
+/*********************************************************************
+* Function: void SSD2805TraceDump(void (*putChar)(char c))
+*
+* Overview: prints the buffered entries, oldest first, one per line
+*
+********************************************************************/
+void SSD2805TraceDump(void (*putChar)(char c))
+{
+	static const char lost[] = "lost ";
+	SSD2805_TRACE_ENTRY entry;
+	DWORD count = _traceCount;
+	DWORD i;
+	BYTE c;
+
+	i = (count > SSD2805_TRACE_SIZE)? (count - SSD2805_TRACE_SIZE) : 0;
+	for(c=0; lost[c]; c++)
+		putChar(lost[c]);
+	SSD2805TracePutHex(putChar, i, 8);
+	putChar('\r'); putChar('\n');
+
+	for(; i != count; i++)
+	{
+		entry = _trace[i & (SSD2805_TRACE_SIZE - 1)];
+		SSD2805TracePutHex(putChar, entry.time, 8);
+		putChar(' ');
+		putChar(entry.type);
+		putChar(' ');
+		SSD2805TracePutHex(putChar, entry.code, 2);
+		putChar(' ');
+		SSD2805TracePutHex(putChar, entry.value, 8);
+		putChar('\r'); putChar('\n');
+	}
+}
+
+/*********************************************************************
+* Function: void SSD2805TraceClear(void)
+*
+* Overview: empties the trace buffer
+*
+********************************************************************/
+void SSD2805TraceClear(void)
+{
+	_traceCount = 0;
+}
+#endif //USE_SSD2805_TRACE
+
+/*********************************************************************
+* Function: void SSD2805GetTimingParams(SSD2805_TIMING_PARAMS *pParams)
+*
+* Overview: settings in use for the timing model, the bus is not
+*			accessed
+*
+********************************************************************/
+void SSD2805GetTimingParams(SSD2805_TIMING_PARAMS *pParams)
+{
+	pParams->busClockHz = GetPeripheralClock();
+	pParams->cpuNsPerCycle = (WORD)((SSD2805_EST_CPU_CYCLES*1000000000ull)/GetSystemClock());
+#if defined (USE_GFX_SPI)
+	pParams->spiClockHz = GetPeripheralClock()/(2*(SSD_SPIBRG + 1));
+	pParams->waitB = 0;
+	pParams->waitM = 0;
+	pParams->waitE = 0;
+	pParams->busBytes = 1;
+#else
+	pParams->spiClockHz = 0;
+	pParams->waitB = _pmpTiming.waitB;
+	pParams->waitM = _pmpTiming.waitM;
+	pParams->waitE = _pmpTiming.waitE;
+	#if defined (USE_16BIT_PMP)
+	pParams->busBytes = 2;
+	#else
+	pParams->busBytes = 1;
+	#endif
+#endif
+	pParams->txClkMHz = SSD_TX_CLK_MHZ;
+	pParams->pllReg = SSD2805ShadowValue(0xba, SSD_PLL_REG);
+	pParams->clkCtrlReg = SSD2805ShadowValue(0xbb, SSD_CLK_CTRL_REG);
+	pParams->configReg = SSD2805ShadowValue(0xb7, 0x0243);
+	pParams->packetSize = SSD2805ShadowValue(0xbe, SSD2805_PACKET_SIZE);	//see SSD2805PlanTransfer()
+	pParams->hsTransitionNs = SSD2805_EST_HS_TRANSITION_NS;
+	pParams->panelNsPerByte = 0;
+	pParams->fifoBytes = SSD2805_EST_FIFO_BYTES;
 }
 
 #endif //#if defined (GFX_USE_SSD2805_MIPI_BRIDGE)
@@ -0,0 +1,254 @@
+/*****************************************************************************
+ *  Module for Microchip Graphics Library
+ *  Solomon Systech. SSD2805 bus and MIPI link timing model
+ *****************************************************************************
+ * FileName:        SSD2805Timing.c
+ * Processor:       PIC32, or any C compiler for host side estimates
+ * Compiler:        MPLAB C32/XC32
+ * Company:         TechToys Company
+ *
+ * Software License Agreement
+ *
+ * You should refer to the license agreement accompanying this Software
+ * for additional information regarding your rights and obligations.
+ *
+ * SOFTWARE AND DOCUMENTATION ARE PROVIDED "AS IS" WITHOUT WARRANTY OF ANY
+ * KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION, ANY WARRANTY
+ * OF MERCHANTABILITY, TITLE, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+ * PURPOSE. IN NO EVENT SHALL MICROCHIP OR ITS LICENSORS BE LIABLE OR
+ * OBLIGATED UNDER CONTRACT, NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION,
+ * BREACH OF WARRANTY, OR OTHER LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT
+ * DAMAGES OR EXPENSES INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL,
+ * INDIRECT, PUNITIVE OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA,
+ * COST OF PROCUREMENT OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY
+ * CLAIMS BY THIRD PARTIES (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF),
+ * OR OTHER SIMILAR COSTS.
+ *
+ * Date			Comment
+ *~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * 02/18/14		Estimates of bus time, frame rate and latency
+ *****************************************************************************/
+#include <string.h>
+#include "GenericTypeDefs.h"
+#include "Graphics/SSD2805Timing.h"
+
+// Bus writes of the address window around each memory write, see
+// SetAddress() and SSD2805WriteBurst(): TDC 4 and TDC n (0xBC, 0xBD
+// each), 0x2A and 0x2B with 4 parameter bytes each, then 0x2C
+#define SSD_EST_WINDOW_REGS		4
+#define SSD_EST_WINDOW_CMDS		3
+#define SSD_EST_WINDOW_PARAMS	4
+
+// MIPI packet overhead in bytes
+#define SSD_EST_SHORT			4		// short packet: data ID, 2 data bytes, ECC
+#define SSD_EST_HEADER			4		// long packet: data ID, word count, ECC
+#define SSD_EST_CRC				2		// long packet checksum
+#define SSD_EST_EOT				4		// EoT packet, 0xB7 bit 9
+
+// 0xB7 bits
+#define SSD_EST_CFG_HS			0x0001
+#define SSD_EST_CFG_EOT			0x0200
+#define SSD_EST_CFG_LPE			0x0400
+
+// Packets in the FIFO the back pressure model keeps track of
+#define SSD_EST_FIFO_SLOTS		16
+
+// Pipeline state, times in ps
+typedef struct
+{
+	QWORD	mcu, link, panel, stall;		// busy times
+	QWORD	fm, fl, fg;						// time each stage is done
+	QWORD	sent[SSD_EST_FIFO_SLOTS];		// packets in the FIFO, time sent
+	DWORD	size[SSD_EST_FIFO_SLOTS];		// and bytes
+	DWORD	fill;							// bytes in the FIFO
+	DWORD	packets;
+	BYTE	head;
+	BYTE	count;
+} SSD_EST_STATE;
+
+/*********************************************************************
+* Function: static DWORD SSD2805EstCycles(const SSD2805_TIMING_PARAMS *p, DWORD bytes)
+*
+* Overview: bus writes for 'bytes' data bytes
+*
+********************************************************************/
+static DWORD SSD2805EstCycles(const SSD2805_TIMING_PARAMS *p, DWORD bytes)
+{
+	return ((p->busBytes > 1)? (bytes + 1)/2 : bytes);
+}
+
+/*********************************************************************
+* Function: static DWORD SSD2805EstCyclePs(const SSD2805_TIMING_PARAMS *p)
+*
+* Overview: time of one bus write in ps. A PMP write cycle takes
+*			WAITB+1 + WAITM+1 + WAITE+1 Tpb, a SPI byte 8 clocks.
+*			The CPU loop may be slower than the bus.
+*
+********************************************************************/
+static DWORD SSD2805EstCyclePs(const SSD2805_TIMING_PARAMS *p)
+{
+	DWORD bus;
+	DWORD cpu = (DWORD)p->cpuNsPerCycle*1000;
+
+	if(p->spiClockHz)
+		bus = (DWORD)(8000000000000ull/p->spiClockHz);
+	else if(p->busClockHz)
+		bus = (DWORD)(((QWORD)p->waitB + 1 + p->waitM + 1 + p->waitE + 1)*1000000000000ull/p->busClockHz);
+	else
+		bus = 0;							//no bus clock, CPU loop only
+	return ((bus > cpu)? bus : cpu);
+}
+
+/*********************************************************************
+* Function: static QWORD SSD2805EstPacketPs(const SSD2805_TIMING_PARAMS *p, DWORD payload)
+*
+* Overview: link time in ps of a packet with 'payload' bytes, DCS
+*			command included. HS rate is the PLL output from 0xBA, LP
+*			rate the LP clock from 0xBB. 0 if the settings give no
+*			link rate.
+*
+********************************************************************/
+static QWORD SSD2805EstPacketPs(const SSD2805_TIMING_PARAMS *p, DWORD payload)
+{
+	DWORD pllMHz, lpKHz, bytes;
+
+	pllMHz = ((DWORD)p->txClkMHz*((p->pllReg & 0x00ff) + 1))/
+			((((p->pllReg >> 12) & 0x0f) + 1)*(((p->pllReg >> 8) & 0x0f) + 1));
+	if(pllMHz == 0)
+		return (0);
+
+	if((payload > 2) || (p->configReg & SSD_EST_CFG_LPE))
+		bytes = SSD_EST_HEADER + payload + SSD_EST_CRC;
+	else
+		bytes = SSD_EST_SHORT;
+	if(p->configReg & SSD_EST_CFG_EOT)
+		bytes += SSD_EST_EOT;
+
+	if(p->configReg & SSD_EST_CFG_HS)
+		return ((QWORD)p->hsTransitionNs*1000 + (QWORD)bytes*8000000/pllMHz);
+
+	lpKHz = (pllMHz*1000)/(8*((p->clkCtrlReg & 0x3f) + 1));
+	if(lpKHz == 0)
+		return (0);
+	return (((QWORD)bytes*8 + SSD2805_EST_LP_OVERHEAD_BITS)*1000000000ull/lpKHz);
+}
+
+/*********************************************************************
+* Function: static void SSD2805EstPacket(const SSD2805_TIMING_PARAMS *p,
+*						SSD_EST_STATE *s, QWORD m, QWORD l, QWORD g, DWORD bytes)
+*
+* Overview: one packet through the pipeline, m, l and g are its MCU,
+*			link and panel times in ps. With a FIFO size set the MCU
+*			first waits until the packets sent by then leave room for
+*			'bytes'. A packet larger than the FIFO waits for it to be
+*			empty.
+*
+********************************************************************/
+static void SSD2805EstPacket(const SSD2805_TIMING_PARAMS *p, SSD_EST_STATE *s, QWORD m, QWORD l, QWORD g, DWORD bytes)
+{
+	QWORD start = s->fm;
+
+	if(p->fifoBytes)
+	{
+		while(s->count && ((s->fill + bytes > p->fifoBytes) || (s->count == SSD_EST_FIFO_SLOTS) || (s->sent[s->head] <= start)))
+		{
+			if(s->sent[s->head] > start)
+				start = s->sent[s->head];
+			s->fill -= s->size[s->head];
+			s->head = (s->head + 1) % SSD_EST_FIFO_SLOTS;
+			s->count--;
+		}
+	}
+
+	s->stall += start - s->fm;
+	s->fm = start + m;
+	s->fl = ((s->fl > s->fm)? s->fl : s->fm) + l;
+	s->fg = ((s->fg > s->fl)? s->fg : s->fl) + g;
+	s->mcu += m;
+	s->link += l;
+	s->panel += g;
+	s->packets++;
+
+	if(p->fifoBytes)
+	{
+		BYTE slot = (s->head + s->count) % SSD_EST_FIFO_SLOTS;
+
+		s->sent[slot] = s->fl;
+		s->size[slot] = bytes;
+		s->fill += bytes;
+		s->count++;
+	}
+}
+
+/*********************************************************************
+* Function: void SSD2805EstimateSequence(const SSD2805_TIMING_PARAMS *pParams,
+*						const DWORD *pBytes, WORD count,
+*						SSD2805_TIMING_ESTIMATE *pEst)
+*
+* Overview: runs the writes through a three stage pipeline. SSD2805
+*			sends a packet once all of its bytes are in, the panel
+*			writes it to GRAM once it is received. Each stage starts a
+*			packet when it is done with the previous one.
+*
+********************************************************************/
+void SSD2805EstimateSequence(const SSD2805_TIMING_PARAMS *pParams, const DWORD *pBytes, WORD count, SSD2805_TIMING_ESTIMATE *pEst)
+{
+	SSD_EST_STATE s;
+	QWORD latency;
+	QWORD cycle = SSD2805EstCyclePs(pParams);
+	QWORD m, l, g;
+	DWORD bytes, size, n;
+	WORD i;
+
+	memset(&s, 0, sizeof(s));
+	for(i = 0; i < count; i++)
+	{
+		// address window, two DCS packets that do not touch GRAM
+		m = (SSD_EST_WINDOW_REGS*(1 + SSD2805EstCycles(pParams, 2)) + SSD_EST_WINDOW_CMDS +
+				2*SSD2805EstCycles(pParams, SSD_EST_WINDOW_PARAMS))*cycle;
+		l = 2*SSD2805EstPacketPs(pParams, 1 + SSD_EST_WINDOW_PARAMS);
+		SSD2805EstPacket(pParams, &s, m, l, 0, 2*(1 + SSD_EST_WINDOW_PARAMS));
+		s.packets++;									//counted as one above
+
+		// pixel bytes, split at the 0xBE packet size
+		bytes = pBytes[i];
+		size = (pParams->packetSize && (pParams->packetSize < bytes))? pParams->packetSize : bytes;
+		while(bytes)
+		{
+			n = (bytes < size)? bytes : size;
+			m = SSD2805EstCycles(pParams, n)*cycle;
+			l = SSD2805EstPacketPs(pParams, n + 1);		//0x2C or 0x3C in front
+			g = (QWORD)n*pParams->panelNsPerByte*1000;
+			SSD2805EstPacket(pParams, &s, m, l, g, n + 1);
+			bytes -= n;
+		}
+	}
+
+	latency = (s.fg > s.fl)? s.fg : s.fl;
+	pEst->mcuNs = (DWORD)(s.mcu/1000);
+	pEst->stallNs = (DWORD)(s.stall/1000);
+	pEst->linkNs = (DWORD)(s.link/1000);
+	pEst->panelNs = (DWORD)(s.panel/1000);
+	pEst->latencyNs = (DWORD)(latency/1000);
+	pEst->packets = s.packets;
+	pEst->fpsX100 = (latency)? (DWORD)(100000000000000ull/latency) : 0;
+
+	if((s.panel >= s.link) && (s.panel >= s.mcu))
+		pEst->limit = SSD2805_EST_LIMIT_PANEL;
+	else if(s.link >= s.mcu)
+		pEst->limit = SSD2805_EST_LIMIT_LINK;
+	else
+		pEst->limit = SSD2805_EST_LIMIT_MCU;
+}
+
+/*********************************************************************
+* Function: void SSD2805EstimateTransfer(const SSD2805_TIMING_PARAMS *pParams,
+*						DWORD bytes, SSD2805_TIMING_ESTIMATE *pEst)
+*
+* Overview: estimate of a single memory write
+*
+********************************************************************/
+void SSD2805EstimateTransfer(const SSD2805_TIMING_PARAMS *pParams, DWORD bytes, SSD2805_TIMING_ESTIMATE *pEst)
+{
+	SSD2805EstimateSequence(pParams, &bytes, 1, pEst);
+}
@@ -66,6 +66,17 @@
 
 #include "GenericTypeDefs.h"
 #include "HardwareProfile.h"
+#include "Graphics/gfxcolors.h"
+#include "Graphics/SSD2805Timing.h"
+
+#ifdef USE_SSD2805_PERF_COUNTERS
+// Bus wait macros of gfxpmp.h/gfxspi.h, timed for SSD2805_PERF_COUNTERS.busyWaitTicks
+extern DWORD _ssd2805BusyTicks;
+#ifndef PMPWaitBusy			// the host build has no PMP to wait for
+#define PMPWaitBusy()	{ if(PMMODEbits.BUSY) { DWORD _t = ReadCoreTimer(); while(PMMODEbits.BUSY); _ssd2805BusyTicks += ReadCoreTimer() - _t; } }
+#endif
+#define SPIWaitBusy()	{ if(!SSD_SPISTATbits.SPIRBF) { DWORD _t = ReadCoreTimer(); while(!SSD_SPISTATbits.SPIRBF); _ssd2805BusyTicks += ReadCoreTimer() - _t; } }
+#endif
 
 #if defined (USE_GFX_PMP)
     #include "Graphics/gfxpmp.h"
@@ -73,11 +84,176 @@
     #include "Graphics/gfxepmp.h"	//for certain PIC24 device only, not relevant here
 #endif 
 
-#if defined (USE_SSD2805_VIDEO_MODE)
-	#include "drv_spi.h"
+#if defined (USE_GFX_SPI)
+	#include "Graphics/gfxspi.h"	//4-wire 8-bit SPI for SSD2805 in video mode
+#endif
+
+/*********************************************************************
+* Section: PLL and clock configuration, defaults are 20MHz TX_CLK,
+*			320MHz PLL, 8MHz LP clock and 10MHz SYS_CLK
+*********************************************************************/
+#ifndef SSD_TX_CLK_MHZ
+	#define SSD_TX_CLK_MHZ		20
+#endif
+#ifndef SSD_PLL_PDIV
+	#define SSD_PLL_PDIV		1
+#endif
+#ifndef SSD_PLL_DIV
+	#define SSD_PLL_DIV			1
+#endif
+#ifndef SSD_PLL_MUL
+	#if defined (SSD_HS_LANE_MBPS)
+		#define SSD_PLL_MUL		((SSD_HS_LANE_MBPS*SSD_PLL_PDIV*SSD_PLL_DIV)/SSD_TX_CLK_MHZ)
+	#else
+		#define SSD_PLL_MUL		16
+	#endif
+#endif
+#ifndef SSD_LP_DIV
+	#define SSD_LP_DIV			5
+#endif
+#ifndef SSD_SYS_CLK_DIV
+	#define SSD_SYS_CLK_DIV		2
+#endif
+
+// PLL output in MHz, equal to the HS bit rate per lane
+#define SSD_PLL_MHZ			((SSD_TX_CLK_MHZ*SSD_PLL_MUL)/(SSD_PLL_PDIV*SSD_PLL_DIV))
+// LP clock in kHz
+#define SSD_LP_CLK_KHZ		((SSD_PLL_MHZ*1000ul)/(8*SSD_LP_DIV))
+
+// register values, PLL = clock*(BAh[7:0]+1)/((BAh[15:12]+1)*(BAh[11:8]+1))
+#define SSD_PLL_REG			((((WORD)SSD_PLL_PDIV-1)<<12)|(((WORD)SSD_PLL_DIV-1)<<8)|((WORD)SSD_PLL_MUL-1))
+// SYS_CLK = TX_CLK/(BBh[7:6]+1), LP clock = PLL/(8*(BBh[5:0]+1))
+#define SSD_CLK_CTRL_REG	((((WORD)SSD_SYS_CLK_DIV-1)<<6)|((WORD)SSD_LP_DIV-1))
+
+// error checking
+#if (SSD_PLL_MUL < 1) || (SSD_PLL_MUL > 256)
+	#error "SSD_PLL_MUL out of range 1..256, check SSD_HS_LANE_MBPS or SSD_PLL_MUL in HardwareProfile.h"
+#endif
+#if (SSD_PLL_PDIV < 1) || (SSD_PLL_PDIV > 16) || (SSD_PLL_DIV < 1) || (SSD_PLL_DIV > 16)
+	#error "SSD_PLL_PDIV and SSD_PLL_DIV must be in range 1..16"
+#endif
+#if defined (SSD_HS_LANE_MBPS) && (SSD_PLL_MHZ != SSD_HS_LANE_MBPS)
+	#error "SSD_HS_LANE_MBPS cannot be reached with SSD_TX_CLK_MHZ, SSD_PLL_PDIV and SSD_PLL_DIV"
+#endif
+#if (SSD_PLL_MHZ < 225) || (SSD_PLL_MHZ > 350)
+	#error "SSD2805 fVCO must be 225MHz..350MHz, max. speed per lane is 350Mbps"
+#endif
+#if (SSD_LP_DIV < 1) || (SSD_LP_DIV > 64)
+	#error "SSD_LP_DIV out of range 1..64"
+#endif
+#if (SSD_LP_CLK_KHZ > 10000)
+	#error "LP clock above 10MHz, increase SSD_LP_DIV"
+#endif
+#if (SSD_SYS_CLK_DIV < 1) || (SSD_SYS_CLK_DIV > 4)
+	#error "SSD_SYS_CLK_DIV out of range 1..4"
+#endif
+
+// Longest wait for PLL lock in ResetDevice()
+#ifndef SSD2805_PLL_LOCK_TIMEOUT_MS
+	#define SSD2805_PLL_LOCK_TIMEOUT_MS		5
+#endif
+
+// Longest time a DCS read may take, all retries included
+#ifndef SSD2805_READ_TIMEOUT_MS
+	#define SSD2805_READ_TIMEOUT_MS			10
+#endif
+
+// Read requests repeated after a timeout or an error report
+#ifndef SSD2805_READ_RETRIES
+	#define SSD2805_READ_RETRIES			2
+#endif
+
+// Dummy bytes the panel returns ahead of memory read data (0x2E/0x3E),
+// check panel spec
+#ifndef SSD2805_READ_DUMMY_BYTES
+	#define SSD2805_READ_DUMMY_BYTES		0
+#endif
+
+// Largest number of pixel bytes per memory read, a multiple of 6 so
+// that 2 and 3 byte pixels both fit whole
+#ifndef SSD2805_READ_CHUNK_BYTES
+	#define SSD2805_READ_CHUNK_BYTES		48
+#endif
+#if (SSD2805_READ_CHUNK_BYTES == 0) || (SSD2805_READ_CHUNK_BYTES % 6) || (SSD2805_READ_CHUNK_BYTES + SSD2805_READ_DUMMY_BYTES > 0xFFFF)
+	#error "SSD2805_READ_CHUNK_BYTES must be a multiple of 6"
 #endif
 
+// Results of SSD2805ReadDCSEx()
+#define SSD2805_READ_OK					0
+#define SSD2805_READ_TIMEOUT			1	// no answer within the time budget
+#define SSD2805_READ_ERROR_REPORT		2	// panel answered with an acknowledge and error report
+#define SSD2805_READ_NO_DATA			3	// read data ready but no bytes returned
+
+// DSI acknowledge and error report bits, SSD2805_READ_INFO.errorReport
+#define SSD2805_ERR_SOT					0x0001	// SoT error
+#define SSD2805_ERR_SOT_SYNC			0x0002	// SoT sync error
+#define SSD2805_ERR_EOT_SYNC			0x0004	// EoT sync error
+#define SSD2805_ERR_ESCAPE				0x0008	// escape mode entry command error
+#define SSD2805_ERR_LP_SYNC				0x0010	// low-power transmit sync error
+#define SSD2805_ERR_HS_TIMEOUT			0x0020	// HS receive timeout
+#define SSD2805_ERR_FALSE_CONTROL		0x0040	// false control error
+#define SSD2805_ERR_CONTENTION			0x0080	// contention detected
+#define SSD2805_ERR_ECC_SINGLE			0x0100	// ECC error, single bit corrected
+#define SSD2805_ERR_ECC_MULTI			0x0200	// ECC error, multi bit
+#define SSD2805_ERR_CHECKSUM			0x0400	// checksum error of a long packet
+#define SSD2805_ERR_DATA_TYPE			0x0800	// data type not recognized
+#define SSD2805_ERR_VC					0x1000	// virtual channel ID invalid
+#define SSD2805_ERR_LENGTH				0x2000	// invalid transmission length
+#define SSD2805_ERR_PROTOCOL			0x8000	// DSI protocol violation
+
+/*********************************************************************
+* Overview: Status of the last DCS read, see SSD2805GetReadInfo()
+*
+*********************************************************************/
+typedef struct
+{
+	BYTE	result;				// SSD2805_READ_OK or an error code
+	BYTE	attempts;			// read requests sent
+	WORD	bytes;				// bytes returned to the caller
+	WORD	interruptStatus;	// last 0xC6 value
+	WORD	errorReport;		// 0xC3, DSI acknowledge and error report, 0 if none
+	WORD	errorStatus;		// 0xC7 after a failed attempt
+} SSD2805_READ_INFO;
+
+/*********************************************************************
+* Function: BYTE SSD2805ReadDCSEx(BYTE cmd, BYTE *pBuf, WORD *pLen)
+*
+* Overview: sends DCS read command 'cmd' and returns up to *pLen bytes
+*			of the answer. The status (0xC6) is polled until data is
+*			ready, an acknowledge and error report arrives or the
+*			panel times out. A failed request is repeated up to
+*			SSD2805_READ_RETRIES times, the whole read never takes
+*			longer than SSD2805_READ_TIMEOUT_MS.
+*
+* Input: cmd - DCS command, pBuf - buffer, *pLen - size of pBuf
+*
+* Output: SSD2805_READ_OK, _TIMEOUT, _ERROR_REPORT or _NO_DATA,
+*		  *pLen - bytes read
+*
+********************************************************************/
+BYTE SSD2805ReadDCSEx(BYTE cmd, BYTE *pBuf, WORD *pLen);
+
+/*********************************************************************
+* Function: BYTE SSD2805ReadDCS(BYTE reg)
+*
+* Overview: reads one byte with DCS command 'reg', see
+*			SSD2805ReadDCSEx()
+*
+* Input: DCS command
+*
+* Output: byte read, 0 if the read failed
+*
+********************************************************************/
 BYTE SSD2805ReadDCS(BYTE reg);
+
+/*********************************************************************
+* Function: void SSD2805GetReadInfo(SSD2805_READ_INFO *pInfo)
+*
+* Overview: returns result, attempts and the error reports of the
+*			last DCS read
+*
+********************************************************************/
+void SSD2805GetReadInfo(SSD2805_READ_INFO *pInfo);
 /************************************************************************
 * Function: void SSD2805WriteReg(BYTE reg, WORD data)                                           
 *                                                                       
@@ -102,6 +278,1146 @@ void SSD2805WriteReg(BYTE reg, WORD data);
 ************************************************************************/
 WORD SSD2805ReadReg(BYTE reg);
 
+/************************************************************************
+* Function: void SSD2805WriteBlock(BYTE cmd, const BYTE *buf, WORD len)
+*                                                                       
+* Overview: same as SSD2805WriteDCS(), kept for existing callers.
+*			Sends a DCS command 'cmd' followed by 'len' parameter bytes
+*			in one chip select window. With USE_GFX_SPI and
+*			SSD_SPI_DMA_CHANNEL defined the parameter bytes are moved
+*			by DMA, otherwise by CPU.
+*                                                                       
+* Input: DCS command, pointer to parameter bytes, number of bytes
+*                                                                       
+* Output: none                                                         
+*                                                                       
+************************************************************************/
+void SSD2805WriteBlock(BYTE cmd, const BYTE *buf, WORD len);
+
+/*********************************************************************
+* Overview: packet flags for SSD2805WriteDCSEx() and SSD2805WriteGeneric()
+*
+********************************************************************/
+#define SSD2805_PACKET_HS		0x00		// high speed, default
+#define SSD2805_PACKET_LP		0x01		// low power escape mode
+#define SSD2805_PACKET_LONG		0x02		// long packet even for 0..1 parameter bytes
+
+/************************************************************************
+* Function: void SSD2805WriteDCS(BYTE cmd, const BYTE *buf, WORD len)
+*                                                                       
+* Overview: sends DCS command 'cmd' followed by 'len' parameter bytes
+*			in HS. TDC (0xBC/0xBD) goes through the register shadow
+*			and is only written when 'len' differs from the last
+*			packet. Command and parameters are sent in one chip
+*			select window.
+*                                                                       
+* Input: DCS command, pointer to parameter bytes (may be NULL if 'len'
+*		 is 0), number of bytes
+*                                                                       
+* Output: none                                                         
+*                                                                       
+************************************************************************/
+void SSD2805WriteDCS(BYTE cmd, const BYTE *buf, WORD len);
+
+/************************************************************************
+* Function: void SSD2805WriteDCSEx(BYTE cmd, const BYTE *buf, WORD len, BYTE flags)
+*                                                                       
+* Overview: same as SSD2805WriteDCS() with the transmission mode and
+*			packet type selected by 'flags'. The HS/DCS/LPE bits of 0xB7
+*			are changed for this packet only and restored afterwards.
+*                                                                       
+* Input: DCS command, parameter bytes, number of bytes,
+*		 SSD2805_PACKET_LP and/or SSD2805_PACKET_LONG
+*                                                                       
+* Output: none                                                         
+*                                                                       
+************************************************************************/
+void SSD2805WriteDCSEx(BYTE cmd, const BYTE *buf, WORD len, BYTE flags);
+
+/************************************************************************
+* Function: void SSD2805WriteGeneric(const BYTE *buf, WORD len, BYTE flags)
+*                                                                       
+* Overview: sends a generic write packet (0x03/0x13/0x23 short, 0x29 long)
+*			with 'len' payload bytes through the packet drop register 0xBF.
+*			Used for manufacturer commands that panels accept only as
+*			generic packets.
+*                                                                       
+* Input: payload, number of bytes, SSD2805_PACKET_LP and/or
+*		 SSD2805_PACKET_LONG
+*                                                                       
+* Output: none                                                         
+*                                                                       
+************************************************************************/
+void SSD2805WriteGeneric(const BYTE *buf, WORD len, BYTE flags);
+
+/*********************************************************************
+* Overview: A rectangle written as a single memory write burst by
+*			SSD2805PresentFrame(). pData is NULL for a solid fill
+*			with 'color'.
+*
+*********************************************************************/
+typedef struct
+{
+	SHORT			left;
+	SHORT			top;
+	SHORT			right;
+	SHORT			bottom;
+	const GFX_COLOR	*pData;
+	GFX_COLOR		color;
+	BYTE			priority;		// SSD2805_PRIORITY_HIGH or SSD2805_PRIORITY_LOW
+	BYTE			age;			// frames this burst has been deferred
+} SSD2805_BURST;
+
+#define SSD2805_PRIORITY_HIGH		0	// written in the frame it is queued for
+#define SSD2805_PRIORITY_LOW		1	// may be deferred by the frame scheduler
+
+// Number of bursts SSD2805PresentFrame() can hold per frame
+#ifndef SSD2805_BURST_QUEUE_SIZE
+	#define SSD2805_BURST_QUEUE_SIZE	16
+#endif
+
+// USE_SSD2805_PMP_IRQ takes one interrupt per PMP strobe. It frees the
+// CPU only if a PMP cycle (WAITB+WAITM+WAITE+3 Tpb) is well above the
+// interrupt entry and exit, about 1us at 40MHz, e.g. with slow panel
+// timing or a low bus clock. With the demo timing a cycle is about
+// 200ns, polling writes faster and the CPU gains next to nothing.
+//
+// Transfers shorter than this many PMP cycles are polled even with
+// USE_SSD2805_PMP_IRQ, interrupt latency would dominate
+#ifndef SSD2805_PMP_IRQ_MIN_CYCLES
+	#define SSD2805_PMP_IRQ_MIN_CYCLES	32
+#endif
+
+// Longest wait for a TE edge before presenting without synchronization
+#ifndef SSD2805_TE_TIMEOUT_MS
+	#define SSD2805_TE_TIMEOUT_MS		40
+#endif
+
+// Line times of V-blank between the TE edge and line 0, panel specific
+#ifndef SSD2805_TE_BLANK_LINES
+	#define SSD2805_TE_BLANK_LINES		16
+#endif
+
+// Lines the scan line estimate is kept behind the panel for TE
+// interrupt latency and frame period jitter
+#ifndef SSD2805_TE_MARGIN_LINES
+	#define SSD2805_TE_MARGIN_LINES		2
+#endif
+
+#ifdef USE_SSD2805_FRAME_SCHEDULER
+// Target frame rate of SSD2805PresentFrame()
+#ifndef SSD2805_FRAME_RATE
+	#define SSD2805_FRAME_RATE			30
+#endif
+
+// Share of the frame period available for bus work
+#ifndef SSD2805_FRAME_BUDGET_PERCENT
+	#define SSD2805_FRAME_BUDGET_PERCENT	80
+#endif
+
+// A low priority burst is written after being deferred this many frames
+#ifndef SSD2805_MAX_DEFER_FRAMES
+	#define SSD2805_MAX_DEFER_FRAMES	4
+#endif
+
+// Window and TDC setup of a burst expressed in pixel write time
+#ifndef SSD2805_BURST_OVERHEAD_PIXELS
+	#define SSD2805_BURST_OVERHEAD_PIXELS	32
+#endif
+
+/*********************************************************************
+* Overview: Frame time statistics of SSD2805PresentFrame(). Times are
+*			bus work per frame in microseconds, measured with the
+*			core timer; waits for frame pacing and TE are excluded.
+*
+*********************************************************************/
+typedef struct
+{
+	DWORD	frames;			// frames presented
+	DWORD	overruns;		// frames over budget
+	DWORD	deferred;		// low priority bursts moved to a later frame
+	DWORD	minUs;
+	DWORD	avgUs;
+	DWORD	maxUs;
+	DWORD	budgetUs;		// bus time budget per frame
+} SSD2805_FRAME_STATS;
+#endif
+
+// Pixels per span buffer of SSD2805FillGradient(), even, two buffers
+// are taken from the stack
+#ifndef SSD2805_GRADIENT_SPAN
+	#define SSD2805_GRADIENT_SPAN		32
+#endif
+#if (SSD2805_GRADIENT_SPAN & 1) || (SSD2805_GRADIENT_SPAN > 254)
+	#error "SSD2805_GRADIENT_SPAN must be even and below 255"
+#endif
+
+#define SSD2805_GRADIENT_HORIZONTAL		0	// color changes from left to right
+#define SSD2805_GRADIENT_VERTICAL		1	// color changes from top to bottom
+#define SSD2805_GRADIENT_DIAGONAL		2	// color changes from top left to bottom right
+
+// Largest MIPI packet payload in bytes, 0xBE threshold for long pixel
+// writes. Rounded down to whole pixels when used.
+#ifndef SSD2805_PACKET_SIZE
+	#define SSD2805_PACKET_SIZE			0x0400
+#endif
+#if (SSD2805_PACKET_SIZE < 3) || (SSD2805_PACKET_SIZE > 0xFFFF)
+	#error "SSD2805_PACKET_SIZE out of range 3..65535"
+#endif
+
+// Rows of GRAM cleared per ResetDeviceTask() call
+#ifndef SSD2805_INIT_CLEAR_ROWS
+	#define SSD2805_INIT_CLEAR_ROWS		16
+#endif
+
+#ifdef USE_SSD2805_CMD_MODE
+// Panel pixel formats, value of DCS set_pixel_format (0x3A). Pixels are
+// sent low byte first: G[2:0]B[4:0], R[4:0]G[5:3] for 16-bit and R, G, B
+// for 18/24-bit, the order of a DCS memory write. In 18-bit format each
+// byte carries 6 bits, left aligned.
+#define SSD2805_PIXEL_FORMAT_16		0x05	// RGB565, 2 bytes per pixel
+#define SSD2805_PIXEL_FORMAT_18		0x06	// RGB666, 3 bytes per pixel
+#define SSD2805_PIXEL_FORMAT_24		0x07	// RGB888, 3 bytes per pixel
+
+// Pixel format set by ResetDevice(), change it at run time with SSD2805SetPixelFormat()
+#ifndef SSD2805_PIXEL_FORMAT
+	#if (COLOR_DEPTH == 24)
+		#define SSD2805_PIXEL_FORMAT	SSD2805_PIXEL_FORMAT_24
+	#else
+		#define SSD2805_PIXEL_FORMAT	SSD2805_PIXEL_FORMAT_16
+	#endif
+#endif
+
+#if (COLOR_DEPTH != 16) && (COLOR_DEPTH != 24)
+	#error "SSD2805 driver supports COLOR_DEPTH 16 and 24"
+#endif
+
+// Define SSD2805_PIXEL_ORDER_BGR in HardwareProfile.h for a panel that
+// takes 18/24-bit pixels B first, i.e. B, G, R
+//#define SSD2805_PIXEL_ORDER_BGR
+
+/*********************************************************************
+* Function: BYTE SSD2805SetPixelFormat(BYTE format)
+*
+* Overview: sets the pixel format of the panel with DCS 0x3A. Colors
+*			keep COLOR_DEPTH, they are converted on the way out, so a
+*			16-bit format can be used during animations to cut the
+*			bytes per pixel from 3 to 2 with COLOR_DEPTH 24, or an
+*			18/24-bit format with COLOR_DEPTH 16. GRAM content is
+*			not converted.
+*
+* Input: format - SSD2805_PIXEL_FORMAT_16, _18 or _24
+*
+* Output: 1 if set, 0 if the format is not supported
+*
+********************************************************************/
+BYTE SSD2805SetPixelFormat(BYTE format);
+
+/*********************************************************************
+* Function: BYTE SSD2805GetPixelFormat(void)
+*
+* Overview: returns the pixel format in use, SSD2805_PIXEL_FORMAT_xx
+*
+********************************************************************/
+BYTE SSD2805GetPixelFormat(void);
+
+// DCS set_address_mode (0x36, MADCTL) bits
+#define SSD2805_MADCTL_MY			0x80	// row address order, bottom to top
+#define SSD2805_MADCTL_MX			0x40	// column address order, right to left
+#define SSD2805_MADCTL_MV			0x20	// row/column exchange
+#define SSD2805_MADCTL_ML			0x10	// vertical refresh order
+#define SSD2805_MADCTL_BGR			0x08	// BGR color filter order
+#define SSD2805_MADCTL_MH			0x04	// horizontal refresh order
+
+// MADCTL per orientation, clockwise. Panels differ in which mirror bit
+// goes with the exchange, override these in HardwareProfile.h if 90 and
+// 270 come out swapped. SSD2805_MADCTL_BASE holds the BGR/refresh bits.
+#ifndef SSD2805_MADCTL_BASE
+	#define SSD2805_MADCTL_BASE		0x00
+#endif
+#ifndef SSD2805_MADCTL_0
+	#define SSD2805_MADCTL_0		0x00
+#endif
+#ifndef SSD2805_MADCTL_90
+	#define SSD2805_MADCTL_90		(SSD2805_MADCTL_MX | SSD2805_MADCTL_MV)
+#endif
+#ifndef SSD2805_MADCTL_180
+	#define SSD2805_MADCTL_180		(SSD2805_MADCTL_MX | SSD2805_MADCTL_MY)
+#endif
+#ifndef SSD2805_MADCTL_270
+	#define SSD2805_MADCTL_270		(SSD2805_MADCTL_MY | SSD2805_MADCTL_MV)
+#endif
+
+// mirror flags of SSD2805SetOrientation(), on screen after rotation
+#define SSD2805_MIRROR_NONE			0x00
+#define SSD2805_MIRROR_X			0x01	// left and right swapped
+#define SSD2805_MIRROR_Y			0x02	// top and bottom swapped
+
+/*********************************************************************
+* Function: BYTE SSD2805SetOrientation(WORD degrees, BYTE mirror)
+*
+* Overview: rotates and mirrors the panel with MADCTL (DCS 0x36), the
+*			panel maps the address window itself so bursts keep their
+*			native row order. ResetDevice() sets DISP_ORIENTATION.
+*			GetMaxX() and GetMaxY() are fixed by DISP_ORIENTATION, so
+*			on a panel that is not square only orientations with the
+*			same width and height are accepted. GRAM content is not
+*			rotated, redraw the screen after a change.
+*
+* Input: degrees - 0, 90, 180 or 270, clockwise
+*		 mirror - SSD2805_MIRROR_NONE or SSD2805_MIRROR_X | SSD2805_MIRROR_Y
+*
+* Output: 1 if set, 0 if the orientation is not supported
+*
+********************************************************************/
+BYTE SSD2805SetOrientation(WORD degrees, BYTE mirror);
+
+/*********************************************************************
+* Function: WORD SSD2805GetOrientation(void)
+*
+* Overview: returns the orientation in degrees set by
+*			SSD2805SetOrientation() or ResetDevice()
+*
+********************************************************************/
+WORD SSD2805GetOrientation(void);
+#endif
+
+/*********************************************************************
+* Function:  void ResetDeviceStart(void)
+*
+* Overview: starts the non-blocking initialization of SSD2805 and the
+*			panel, ResetDeviceTask() completes it
+*
+* Input: none
+*
+* Output: none
+*
+********************************************************************/
+void ResetDeviceStart(void);
+
+/*********************************************************************
+* Function:  BYTE ResetDeviceTask(void)
+*
+* Overview: advances the initialization by one step without waiting,
+*			call it from the main loop or a periodic timer interrupt
+*			until it returns 1. ResetDevice() is the blocking form.
+*
+* Input: none
+*
+* Output: 1 when initialization is complete, 0 while in progress
+*
+********************************************************************/
+BYTE ResetDeviceTask(void);
+
+/*********************************************************************
+* Overview: Init sequences. A sequence is a const BYTE array in flash,
+*			built from the SSD2805_SEQ_xxx macros below and ended by
+*			SSD2805_SEQ_END. Words are stored high byte first.
+*
+*			SSD2805_SEQ_REG(reg, data)	bridge register write
+*			SSD2805_SEQ_DCS(cmd, n)		DCS write, followed by its n
+*										parameter bytes
+*			SSD2805_SEQ_DELAY(ms)		wait
+*			SSD2805_SEQ_POLL(reg, mask, value, ms)
+*										wait until (reg & mask) == value,
+*										at most ms
+*			SSD2805_SEQ_VC(vc)			virtual channel (0xB8) of the
+*										following packets
+*
+*			Example:
+*			const BYTE mySeq[] =
+*			{
+*				SSD2805_SEQ_VC(0),
+*				SSD2805_SEQ_DCS(0x11, 0),
+*				SSD2805_SEQ_DELAY(120),
+*				SSD2805_SEQ_DCS(0xf0, 2), 0x5a, 0x5a,
+*				SSD2805_SEQ_END
+*			};
+*
+*********************************************************************/
+#define SSD2805_OP_END				0x00
+#define SSD2805_OP_REG				0x01
+#define SSD2805_OP_DCS				0x02
+#define SSD2805_OP_DELAY			0x03
+#define SSD2805_OP_POLL				0x04
+#define SSD2805_OP_VC				0x05
+
+#define SSD2805_SEQ_W(w)			(BYTE)((w)>>8), (BYTE)(w)
+#define SSD2805_SEQ_END				SSD2805_OP_END
+#define SSD2805_SEQ_REG(reg, data)	SSD2805_OP_REG, (reg), SSD2805_SEQ_W(data)
+#define SSD2805_SEQ_DCS(cmd, n)		SSD2805_OP_DCS, (cmd), (n)
+#define SSD2805_SEQ_DELAY(ms)		SSD2805_OP_DELAY, SSD2805_SEQ_W(ms)
+#define SSD2805_SEQ_POLL(reg, mask, value, ms)	SSD2805_OP_POLL, (reg), SSD2805_SEQ_W(mask), SSD2805_SEQ_W(value), SSD2805_SEQ_W(ms)
+#define SSD2805_SEQ_VC(vc)			SSD2805_OP_VC, (vc)
+
+// Results of SSD2805SeqTask() and SSD2805RunSeq()
+#define SSD2805_SEQ_BUSY			0	// in progress
+#define SSD2805_SEQ_OK				1	// done
+#define SSD2805_SEQ_TIMEOUT			2	// done, a poll ran out of time
+#define SSD2805_SEQ_ERROR			3	// unknown opcode, stopped
+
+// Panel sequences, run by ResetDeviceTask() once SSD2805 is set up:
+// virtual channel, sleep-out and the panel specific commands
+extern const BYTE SSD2805SeqLH154Q01[];		// LG LH154Q01
+#define SSD2805SeqH154QN01	SSD2805SeqLH154Q01	// AUO H154QN01 V2, no commands of its own
+
+// Sequence of the panel in use, a sequence of the application can be
+// given here as well
+#ifndef SSD2805_PANEL_SEQ
+	#if defined (GFX_USE_DISPLAY_PANEL_TFT_LH154Q01)
+		#define SSD2805_PANEL_SEQ	SSD2805SeqLH154Q01
+	#else
+		#define SSD2805_PANEL_SEQ	SSD2805SeqH154QN01
+	#endif
+#endif
+
+/*********************************************************************
+* Function: void SSD2805SeqStart(const BYTE *pSeq)
+*
+* Overview: starts an init sequence, SSD2805SeqTask() runs it. Only
+*			one sequence runs at a time, ResetDeviceTask() and
+*			SSD2805SleepOut() use it as well.
+*
+* Input: pSeq - sequence
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805SeqStart(const BYTE *pSeq);
+
+/*********************************************************************
+* Function: BYTE SSD2805SeqTask(void)
+*
+* Overview: runs the sequence up to the next delay or poll that is not
+*			over yet and returns without waiting
+*
+* Input: none
+*
+* Output: SSD2805_SEQ_BUSY while in progress, then SSD2805_SEQ_OK,
+*		  _TIMEOUT or _ERROR
+*
+********************************************************************/
+BYTE SSD2805SeqTask(void);
+
+/*********************************************************************
+* Function: BYTE SSD2805RunSeq(const BYTE *pSeq)
+*
+* Overview: blocking form of SSD2805SeqStart() and SSD2805SeqTask()
+*
+* Input: pSeq - sequence
+*
+* Output: SSD2805_SEQ_OK, _TIMEOUT or _ERROR
+*
+********************************************************************/
+BYTE SSD2805RunSeq(const BYTE *pSeq);
+
+/*********************************************************************
+* Function: DWORD SSD2805SeqGetTime(void)
+*
+* Overview: returns how long the last completed sequence took, delays
+*			and polls included
+*
+* Input: none
+*
+* Output: time in microseconds
+*
+********************************************************************/
+DWORD SSD2805SeqGetTime(void);
+
+/*********************************************************************
+* Function: void SSD2805SetIdleMode(BYTE enable)
+*
+* Overview: turns the panel idle mode on or off (DCS 0x39/0x38). In
+*			idle mode the panel shows 8 colors, the MSB of each
+*			channel, and uses less power on static screens.
+*
+* Input: enable - 1 for idle mode, 0 for full colors
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805SetIdleMode(BYTE enable);
+
+/*********************************************************************
+* Function: void SSD2805SetPartialArea(WORD startRow, WORD endRow)
+*
+* Overview: shows only rows startRow to endRow, the rest of the panel
+*			is not driven (DCS 0x30 then 0x12). SSD2805SetNormalMode()
+*			shows the full screen again.
+*
+* Input: startRow, endRow - rows shown, inclusive
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805SetPartialArea(WORD startRow, WORD endRow);
+
+/*********************************************************************
+* Function: void SSD2805SetNormalMode(void)
+*
+* Overview: leaves partial mode (DCS 0x13)
+*
+* Input: none
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805SetNormalMode(void);
+
+/*********************************************************************
+* Function: void SSD2805SleepIn(void)
+*
+* Overview: puts the panel to sleep (DCS 0x10) with GRAM kept, then
+*			the SSD2805 to its lowest power state: MIPI lanes in ULPS
+*			and PLL off. Takes about 5ms. No other driver call may be
+*			made until SSD2805SleepOut().
+*
+* Input: none
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805SleepIn(void);
+
+/*********************************************************************
+* Function: BYTE SSD2805SleepOut(void)
+*
+* Overview: restarts the SSD2805 PLL and wakes the panel (DCS 0x11).
+*			GRAM content is shown again without a redraw. Takes the
+*			PLL lock time plus 5ms, panels need 120ms between
+*			sleep-in and sleep-out, an earlier call waits for it.
+*
+* Input: none
+*
+* Output: 1 if the PLL locked, 0 if the interface stays at the
+*		  oscillator timing
+*
+********************************************************************/
+BYTE SSD2805SleepOut(void);
+
+// PWM frequency of the backlight, above the audible range
+#ifndef SSD2805_BACKLIGHT_PWM_HZ
+	#define SSD2805_BACKLIGHT_PWM_HZ		20000ul
+#endif
+
+// Fade time of SSD2805BacklightTask() to the dim level, and back on activity
+#ifndef SSD2805_BACKLIGHT_DIM_FADE_MS
+	#define SSD2805_BACKLIGHT_DIM_FADE_MS	500
+#endif
+#ifndef SSD2805_BACKLIGHT_WAKE_FADE_MS
+	#define SSD2805_BACKLIGHT_WAKE_FADE_MS	100
+#endif
+
+// Longest auto-dim time, the time since the last activity is kept in us
+// on 32 bits and wraps after 4294s
+#define SSD2805_BACKLIGHT_DIM_MAX_S		2000
+
+/*********************************************************************
+* Function: void SSD2805SetBacklight(BYTE level)
+*
+* Overview: sets the backlight level at once, 0 is off and 255 full.
+*			With USE_SSD2805_BACKLIGHT_PWM the level sets the duty of
+*			the output compare PWM on a perceptual curve (duty grows
+*			with the square of the level), otherwise it is sent to
+*			the panel as DCS 0x51.
+*
+* Input: level - 0..255
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805SetBacklight(BYTE level);
+
+/*********************************************************************
+* Function: BYTE SSD2805GetBacklight(void)
+*
+* Overview: returns the level last set, the target of a running fade
+*
+********************************************************************/
+BYTE SSD2805GetBacklight(void);
+
+/*********************************************************************
+* Function: void SSD2805SetPanelBrightness(BYTE value)
+*
+* Overview: sets the panel side brightness with DCS 0x51, for panels
+*			that control their own backlight or apply it to the
+*			pixel data. Independent of the PWM backlight.
+*
+* Input: value - 0..255
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805SetPanelBrightness(BYTE value);
+
+// DCS write_ctrl_display (0x53) bits
+#define SSD2805_CTRL_BCTRL		0x20	// brightness control block on
+#define SSD2805_CTRL_DD			0x08	// display dimming
+#define SSD2805_CTRL_BL			0x04	// backlight on
+
+// DCS write_content_adaptive_brightness (0x55) modes
+#define SSD2805_CABC_OFF		0x00
+#define SSD2805_CABC_UI			0x01	// user interface images
+#define SSD2805_CABC_STILL		0x02	// still pictures
+#define SSD2805_CABC_MOVING		0x03	// moving images
+
+/*********************************************************************
+* Function: void SSD2805SetPanelControl(BYTE ctrl, BYTE cabc)
+*
+* Overview: sets the panel brightness control (DCS 0x53) and the
+*			content adaptive brightness mode (DCS 0x55) where the
+*			panel supports them
+*
+* Input: ctrl - SSD2805_CTRL_BCTRL | SSD2805_CTRL_DD | SSD2805_CTRL_BL
+*		 cabc - SSD2805_CABC_OFF, _UI, _STILL or _MOVING
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805SetPanelControl(BYTE ctrl, BYTE cabc);
+
+#ifdef USE_SSD2805_BACKLIGHT_PWM
+/*********************************************************************
+* Function: void SSD2805BacklightFade(BYTE level, WORD ms)
+*
+* Overview: ramps the backlight to 'level' over 'ms' milliseconds.
+*			The duty is stepped from the timer interrupt once per PWM
+*			period and the call returns at once, a new call takes
+*			over from the current duty.
+*
+* Input: level - 0..255, ms - fade time, 0 to set at once
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805BacklightFade(BYTE level, WORD ms);
+
+/*********************************************************************
+* Function: void SSD2805BacklightAutoDim(WORD seconds, BYTE dimLevel)
+*
+* Overview: fades the backlight to dimLevel after 'seconds' without
+*			SSD2805BacklightActivity(), see SSD2805BacklightTask().
+*			0 seconds turns auto-dim off.
+*
+* Input: seconds - 1..SSD2805_BACKLIGHT_DIM_MAX_S (2000), more is
+*				  clamped, or 0
+*		 dimLevel - 0..255
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805BacklightAutoDim(WORD seconds, BYTE dimLevel);
+
+/*********************************************************************
+* Function: void SSD2805BacklightActivity(void)
+*
+* Overview: call on user input, restarts the auto-dim time and fades
+*			a dimmed backlight back to its level
+*
+********************************************************************/
+void SSD2805BacklightActivity(void);
+
+/*********************************************************************
+* Function: void SSD2805BacklightTask(void)
+*
+* Overview: starts the auto-dim fade when the time is up, call it from
+*			the main loop. It only compares time stamps.
+*
+********************************************************************/
+void SSD2805BacklightTask(void);
+#endif
+
+/*********************************************************************
+* Function:  SSD2805SetWindow(WORD left, WORD top, WORD right, WORD bottom)
+*
+* Overview: Writes Column and Page Addresses for a window, subsequent
+*			memory write (0x2C) fills the window row by row
+*
+* Input: window borders, inclusive
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805SetWindow(WORD left, WORD top, WORD right, WORD bottom);
+
+/*********************************************************************
+* Function: void SSD2805SetTearingSync(BYTE enable)
+*
+* Overview: enables or disables the panel TE output (DCS 0x35/0x34)
+*			and the TE input capture interrupt. Available with
+*			USE_SSD2805_TE_SYNC defined in HardwareProfile.h, then
+*			ResetDevice()/ResetDeviceTask() enable it at the end of
+*			initialization. Call it with 0 to present frames without
+*			waiting for TE.
+*
+* Input: enable - 1 to enable, 0 to disable
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805SetTearingSync(BYTE enable);
+
+/*********************************************************************
+* Function: BYTE SSD2805QueueBurst(SHORT left, SHORT top, SHORT right,
+*								SHORT bottom, const GFX_COLOR *pData)
+*
+* Overview: queues a rectangle for the next SSD2805PresentFrame(), a
+*			solid fill with the current color if pData is NULL
+*
+* Input: rectangle borders, inclusive, and pixel data or NULL
+*
+* Output: 1 if queued, 0 if the queue is full
+*
+********************************************************************/
+BYTE SSD2805QueueBurst(SHORT left, SHORT top, SHORT right, SHORT bottom, const GFX_COLOR *pData);
+
+/*********************************************************************
+* Function: BYTE SSD2805QueueBurstEx(SHORT left, SHORT top, SHORT right,
+*						SHORT bottom, const GFX_COLOR *pData, BYTE priority)
+*
+* Overview: as SSD2805QueueBurst() with a priority, low priority
+*			bursts may be deferred to a later frame when the frame
+*			budget would be exceeded
+*
+* Input: rectangle borders, inclusive, pixel data or NULL, priority
+*
+* Output: 1 if queued, 0 if the queue is full
+*
+********************************************************************/
+BYTE SSD2805QueueBurstEx(SHORT left, SHORT top, SHORT right, SHORT bottom, const GFX_COLOR *pData, BYTE priority);
+
+/*********************************************************************
+* Function: WORD SSD2805PresentFrame(void)
+*
+* Overview: writes the queued bursts, starting on the next TE edge
+*			and ordered top to bottom when tearing sync is enabled
+*
+* Input: none
+*
+* Output: number of bursts written
+*
+********************************************************************/
+WORD SSD2805PresentFrame(void);
+
+/*********************************************************************
+* Function: void SSD2805PushRaw(SHORT left, SHORT top, SHORT right,
+*						SHORT bottom, const BYTE *pData)
+*
+* Overview: writes a rectangle of pixels that are already in panel
+*			byte order, row by row, as one memory write burst. The
+*			bytes go out as they are, without per pixel shifts or
+*			conversion, by an unrolled loop, the PMP interrupt or SPI
+*			DMA. The panel takes each pixel low byte first:
+*			- SSD2805_PIXEL_FORMAT_16: G[2:0]B[4:0], R[4:0]G[5:3],
+*			  the same bytes as a RGB565 WORD in PIC32 memory
+*			- SSD2805_PIXEL_FORMAT_18/_24: R, G, B (B, G, R with
+*			  SSD2805_PIXEL_ORDER_BGR), 3 bytes without padding,
+*			  18-bit values left aligned in each byte
+*			Assets for this path are stored in this order by the asset
+*			converter. No clipping is done.
+*
+* Input: rectangle borders, inclusive, and
+*		 (right-left+1)*(bottom-top+1)*bytes per pixel bytes
+*
+* Output: none
+*
+* Note: with USE_SSD2805_PMP_IRQ or SPI DMA pData must stay valid
+*		until IsDeviceBusy() returns 0. With 16-bit PMP a word
+*		aligned pData is fastest.
+*
+********************************************************************/
+void SSD2805PushRaw(SHORT left, SHORT top, SHORT right, SHORT bottom, const BYTE *pData);
+
+/*********************************************************************
+* Function: DWORD SSD2805RawBegin(SHORT left, SHORT top, SHORT right, SHORT bottom)
+*
+* Overview: as SSD2805PushRaw() for data that arrives in pieces, e.g.
+*			rows read from external flash. Starts the burst, the bytes
+*			follow with SSD2805RawWrite() calls and no other driver
+*			call may be made until all of them are written.
+*
+* Input: rectangle borders, inclusive
+*
+* Output: number of bytes the burst takes
+*
+********************************************************************/
+DWORD SSD2805RawBegin(SHORT left, SHORT top, SHORT right, SHORT bottom);
+
+/*********************************************************************
+* Function: void SSD2805RawWrite(const BYTE *pData, DWORD bytes)
+*
+* Overview: writes the next bytes of a burst started with
+*			SSD2805RawBegin(). Pieces may have any length, with 16-bit
+*			PMP the odd last byte of a piece is sent together with the
+*			first byte of the next piece.
+*
+* Input: pData - bytes in panel byte order, bytes - number of bytes
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805RawWrite(const BYTE *pData, DWORD bytes);
+
+/*********************************************************************
+* Function: void SSD2805FillGradient(SHORT left, SHORT top, SHORT right,
+*						SHORT bottom, GFX_COLOR startColor,
+*						GFX_COLOR endColor, BYTE direction, BYTE dither)
+*
+* Overview: fills a rectangle with a linear gradient from startColor
+*			to endColor, written at once as a single memory write
+*			burst. With 'dither' set a 4x4 ordered dither hides the
+*			banding of RGB565 and RGB666.
+*
+* Input: rectangle borders, inclusive, end colors,
+*		 direction - SSD2805_GRADIENT_HORIZONTAL, _VERTICAL or _DIAGONAL,
+*		 dither - 1 to dither
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805FillGradient(SHORT left, SHORT top, SHORT right, SHORT bottom, GFX_COLOR startColor, GFX_COLOR endColor, BYTE direction, BYTE dither);
+
+/*********************************************************************
+* Overview: Supplies the background of a rectangle to a sprite, e.g.
+*			rendered from the strip buffer the screen is drawn from.
+*			Row y of the rectangle goes to pDst + (y - top)*stride.
+*
+*********************************************************************/
+typedef void (*SSD2805_BACKGROUND_FUNC)(SHORT left, SHORT top, SHORT right, SHORT bottom, GFX_COLOR *pDst, WORD stride);
+
+/*********************************************************************
+* Overview: A small image moved over a static background, such as a
+*			cursor or a needle. Set up with SSD2805SpriteInit(), the
+*			fields are private except pImage, useKey and keyColor.
+*
+*********************************************************************/
+typedef struct
+{
+	const GFX_COLOR			*pImage;	// width*height pixels, row by row
+	GFX_COLOR				*pSave;		// background under the sprite
+	GFX_COLOR				*pWork;		// next save-under, or the composed sprite
+	SSD2805_BACKGROUND_FUNC	getBackground;	// NULL to read the background back from GRAM
+	GFX_COLOR				keyColor;	// image pixels of this color are transparent
+	BYTE					useKey;		// 1 to use keyColor
+	BYTE					visible;
+	SHORT					x;			// position on screen
+	SHORT					y;
+	WORD					width;
+	WORD					height;
+} SSD2805_SPRITE;
+
+/*********************************************************************
+* Function: void SSD2805SpriteInit(SSD2805_SPRITE *pSprite, const GFX_COLOR *pImage,
+*						WORD width, WORD height, GFX_COLOR *pBuffer,
+*						SSD2805_BACKGROUND_FUNC getBackground)
+*
+* Overview: sets up a hidden sprite. pBuffer holds 2*width*height
+*			pixels for the save-under and a work copy. The background
+*			under the sprite is asked from getBackground, or read
+*			back from GRAM if it is NULL, one window and a DCS read
+*			per SSD2805_READ_CHUNK_BYTES. Either way a pixel is
+*			fetched once, when the sprite first covers it.
+*
+* Input: pSprite - sprite, pImage - sprite pixels, width, height - size,
+*		 pBuffer - 2*width*height pixels, getBackground - background or NULL
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805SpriteInit(SSD2805_SPRITE *pSprite, const GFX_COLOR *pImage, WORD width, WORD height, GFX_COLOR *pBuffer, SSD2805_BACKGROUND_FUNC getBackground);
+
+/*********************************************************************
+* Function: void SSD2805SpriteMove(SSD2805_SPRITE *pSprite, SHORT x, SHORT y)
+*
+* Overview: shows the sprite with its top left corner at (x, y), kept
+*			inside the screen. Only the background the move exposes
+*			is restored, then the sprite is written over its new
+*			rectangle, each as a windowed burst, about 1 KB of bus
+*			traffic for a 16x16 cursor in RGB565. Calling it at the
+*			same position redraws a changed pImage. The background
+*			under a visible sprite must not be drawn over, hide the
+*			sprite first.
+*
+* Input: pSprite - sprite, x, y - new position
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805SpriteMove(SSD2805_SPRITE *pSprite, SHORT x, SHORT y);
+
+/*********************************************************************
+* Function: void SSD2805SpriteHide(SSD2805_SPRITE *pSprite)
+*
+* Overview: removes the sprite, the saved background is written back
+*
+* Input: pSprite - sprite
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805SpriteHide(SSD2805_SPRITE *pSprite);
+
+#ifdef USE_SSD2805_FRAME_SCHEDULER
+/*********************************************************************
+* Function: void SSD2805SchedulerInit(WORD framesPerSecond, BYTE budgetPercent)
+*
+* Overview: sets target frame rate and bus time budget per frame and
+*			clears the statistics. Called with defaults on the first
+*			SSD2805PresentFrame() if not called by the application.
+*
+* Input: framesPerSecond - 0 for SSD2805_FRAME_RATE
+*		 budgetPercent - 0 for SSD2805_FRAME_BUDGET_PERCENT
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805SchedulerInit(WORD framesPerSecond, BYTE budgetPercent);
+
+/*********************************************************************
+* Function: void SSD2805GetFrameStats(SSD2805_FRAME_STATS *pStats)
+*
+* Overview: copies the frame time statistics
+*
+********************************************************************/
+void SSD2805GetFrameStats(SSD2805_FRAME_STATS *pStats);
+
+/*********************************************************************
+* Function: DWORD SSD2805GetFrameTimePercentile(BYTE percent)
+*
+* Overview: returns the frame time in microseconds not exceeded by
+*			'percent' of the frames, resolution is 1/16 of the budget
+*
+********************************************************************/
+DWORD SSD2805GetFrameTimePercentile(BYTE percent);
+
+/*********************************************************************
+* Function: void SSD2805ResetFrameStats(void)
+*
+* Overview: clears the frame time statistics
+*
+********************************************************************/
+void SSD2805ResetFrameStats(void);
+#endif
+
+/*********************************************************************
+* Function: void SSD2805ConvertRow888(WORD *pDst, const BYTE *pSrc,
+*						WORD count, SHORT x, SHORT y, BYTE dither)
+*
+* Overview: converts a row of 'count' RGB888 pixels, stored as R, G, B
+*			bytes, to RGB565. Two pixels are converted per 32-bit
+*			word. With 'dither' set a 4x4 ordered (Bayer) dither is
+*			applied, its phase taken from the screen position (x, y)
+*			of the first pixel so that adjacent rows and strips line
+*			up. With COLOR_DEPTH 16 pDst can be the pixel buffer of a
+*			burst, see SSD2805QueueBurst(). A host build with SSE2
+*			converts runs of 16 pixels at a time, with the same
+*			result, unless SSD2805_NO_SIMD is defined.
+*
+* Input: pDst - destination row, pSrc - source row, count - pixels,
+*		 x, y - screen position of the first pixel, dither - 1 to dither
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805ConvertRow888(WORD *pDst, const BYTE *pSrc, WORD count, SHORT x, SHORT y, BYTE dither);
+
+/*********************************************************************
+* Function: WORD SSD2805Blend565(WORD fg, WORD bg, BYTE alpha)
+*
+* Overview: blends two RGB565 colors. 'alpha' runs from 0 (bg only)
+*			to 255 (fg only) and is applied in 33 steps, the finest
+*			a 5-bit channel can show.
+*
+* Input: fg - foreground color, bg - background color, alpha - weight of fg
+*
+* Output: blended color
+*
+********************************************************************/
+WORD SSD2805Blend565(WORD fg, WORD bg, BYTE alpha);
+
+/*********************************************************************
+* Function: void SSD2805FillRowAlpha(WORD *pDst, WORD color, WORD count, BYTE alpha)
+*
+* Overview: blends 'color' over 'count' RGB565 pixels in place, two
+*			pixels per 32-bit word. Used for semi-transparent fills
+*			and fades into a strip buffer that is then sent with
+*			SSD2805QueueBurst(), no GRAM readback is needed.
+*
+* Input: pDst - row to blend into, color - fill color, count - pixels,
+*		 alpha - 0 (no change) to 255 (solid)
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805FillRowAlpha(WORD *pDst, WORD color, WORD count, BYTE alpha);
+
+/*********************************************************************
+* Function: void SSD2805BlendRow(WORD *pDst, const WORD *pSrc, WORD count, BYTE alpha)
+*
+* Overview: blends a row of RGB565 pixels over pDst with constant
+*			alpha, two pixels per 32-bit word
+*
+* Input: pDst - row to blend into, pSrc - foreground row, count - pixels,
+*		 alpha - 0 (no change) to 255 (copy)
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805BlendRow(WORD *pDst, const WORD *pSrc, WORD count, BYTE alpha);
+
+/*********************************************************************
+* Function: void SSD2805BlendRowA8(WORD *pDst, WORD color, const BYTE *pMask, WORD count)
+*
+* Overview: blends 'color' over a row of RGB565 pixels through an A8
+*			mask, one alpha byte per pixel. Fully transparent and
+*			fully opaque pixels skip the blend.
+*
+* Input: pDst - row to blend into, color - foreground color,
+*		 pMask - alpha bytes, count - pixels
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805BlendRowA8(WORD *pDst, WORD color, const BYTE *pMask, WORD count);
+
+/*********************************************************************
+* Function: void SSD2805BlendRowARGB4444(WORD *pDst, const WORD *pSrc, WORD count)
+*
+* Overview: blends a row of ARGB4444 image pixels (alpha in bits 15:12)
+*			over a row of RGB565 pixels
+*
+* Input: pDst - row to blend into, pSrc - ARGB4444 row, count - pixels
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805BlendRowARGB4444(WORD *pDst, const WORD *pSrc, WORD count);
+
+#ifdef USE_SSD2805_PERF_COUNTERS
+/*********************************************************************
+* Overview: Cumulative bus counters of the driver since the last
+*			SSD2805ResetPerfCounters(). Bytes count every byte moved
+*			over the MCU interface, command bytes included. Local
+*			register writes of cacheable registers (0xB1-0xB8,
+*			0xBA-0xBE, 0xD6) are skipped when the register already
+*			holds the value, these count as elided.
+*
+*********************************************************************/
+typedef struct
+{
+	DWORD	bytesWritten;
+	DWORD	bytesRead;
+	DWORD	regWrites;			// local register writes sent
+	DWORD	regWritesElided;	// local register writes skipped
+	DWORD	dcsCommands;		// DCS commands and packets to the panel
+	DWORD	windows;			// column/page address windows set
+	DWORD	bursts;				// memory writes (0x2C)
+	DWORD	burstBytes;			// pixel bytes of all bursts
+	DWORD	avgBurstBytes;		// burstBytes/bursts
+	DWORD	busyWaitTicks;		// core timer ticks spinning in PMPWaitBusy()/SPIWaitBusy()
+	DWORD	statusWaitTicks;	// core timer ticks polling 0xC6, PLL lock and read ready
+	DWORD	readRetries;		// DCS read requests repeated
+	DWORD	readFailures;		// DCS reads that failed after all retries
+} SSD2805_PERF_COUNTERS;
+
+/*********************************************************************
+* Function: void SSD2805GetPerfCounters(SSD2805_PERF_COUNTERS *pCounters)
+*
+* Overview: copies the counters, avgBurstBytes is computed here
+*
+********************************************************************/
+void SSD2805GetPerfCounters(SSD2805_PERF_COUNTERS *pCounters);
+
+/*********************************************************************
+* Function: void SSD2805ResetPerfCounters(void)
+*
+* Overview: clears the counters
+*
+********************************************************************/
+void SSD2805ResetPerfCounters(void);
+#endif
+
+#ifdef USE_SSD2805_TRACE
+// Entries in the bus trace ring buffer, must be a power of 2
+#ifndef SSD2805_TRACE_SIZE
+	#define SSD2805_TRACE_SIZE			64
+#endif
+#if (SSD2805_TRACE_SIZE & (SSD2805_TRACE_SIZE - 1))
+	#error "SSD2805_TRACE_SIZE must be a power of 2"
+#endif
+
+// Trace entry types
+#define SSD2805_TRACE_REG			'R'		// local register write, code = register
+#define SSD2805_TRACE_READ			'r'		// local register read, code = register
+#define SSD2805_TRACE_DCS			'D'		// DCS packet, code = command, value = parameter bytes (TDC)
+#define SSD2805_TRACE_DCS_READ		'd'		// DCS read, code = command, value = byte returned
+#define SSD2805_TRACE_BURST			'B'		// memory write, code = 0x2C, value = bytes
+
+/*********************************************************************
+* Overview: One bus trace entry. SSD2805_TRACE_LITE records only the
+*			SSD2805_TRACE_DCS and SSD2805_TRACE_BURST types.
+*
+*********************************************************************/
+typedef struct
+{
+	DWORD	time;			// core timer, TIME_TICKS_PER_US ticks per us
+	DWORD	value;
+	BYTE	type;			// SSD2805_TRACE_xxx
+	BYTE	code;
+} SSD2805_TRACE_ENTRY;
+
+/*********************************************************************
+* Function: WORD SSD2805TraceSnapshot(SSD2805_TRACE_ENTRY *pBuf, WORD max)
+*
+* Overview: copies up to 'max' of the most recent entries, oldest first
+*
+* Output: number of entries copied
+*
+********************************************************************/
+WORD SSD2805TraceSnapshot(SSD2805_TRACE_ENTRY *pBuf, WORD max);
+
+/*********************************************************************
+* Function: void SSD2805TraceDump(void (*putChar)(char c))
+*
+* Overview: prints the buffered entries, oldest first, one line each:
+*			"tttttttt T cc vvvvvvvv" in hex with time in core timer
+*			ticks, the type letter, code and value. A first line
+*			"lost nnnnnnnn" counts entries overwritten since the last
+*			SSD2805TraceClear().
+*
+* Input: putChar - character output, e.g. a UART write
+*
+********************************************************************/
+void SSD2805TraceDump(void (*putChar)(char c));
+
+/*********************************************************************
+* Function: void SSD2805TraceClear(void)
+*
+* Overview: empties the trace buffer
+*
+********************************************************************/
+void SSD2805TraceClear(void);
+#endif
+
+// CPU cycles per bus write in the driver pixel loops, for the timing model
+#ifndef SSD2805_EST_CPU_CYCLES
+	#define SSD2805_EST_CPU_CYCLES		6
+#endif
+
+/*********************************************************************
+* Function: void SSD2805GetTimingParams(SSD2805_TIMING_PARAMS *pParams)
+*
+* Overview: fills the parameters of the timing model (SSD2805Timing.h)
+*			with the PMP/SPI timing and SSD2805 registers in use, as a
+*			starting point for SSD2805EstimateSequence()
+*
+* Input: pParams - parameters
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805GetTimingParams(SSD2805_TIMING_PARAMS *pParams);
+
 /*********************************************************************
 * Function: void ClearDevice(void)
 *
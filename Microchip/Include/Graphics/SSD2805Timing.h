@@ -0,0 +1,153 @@
+/*****************************************************************************
+ *  Module for Microchip Graphics Library
+ *  Solomon Systech. SSD2805 bus and MIPI link timing model
+ *****************************************************************************
+ * FileName:        SSD2805Timing.h
+ * Processor:       PIC32, or any C compiler for host side estimates
+ * Compiler:        MPLAB C32/XC32
+ * Company:         TechToys Company
+ *
+ * Software License Agreement
+ *
+ * You should refer to the license agreement accompanying this Software
+ * for additional information regarding your rights and obligations.
+ *
+ * SOFTWARE AND DOCUMENTATION ARE PROVIDED "AS IS" WITHOUT WARRANTY OF ANY
+ * KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION, ANY WARRANTY
+ * OF MERCHANTABILITY, TITLE, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+ * PURPOSE. IN NO EVENT SHALL MICROCHIP OR ITS LICENSORS BE LIABLE OR
+ * OBLIGATED UNDER CONTRACT, NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION,
+ * BREACH OF WARRANTY, OR OTHER LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT
+ * DAMAGES OR EXPENSES INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL,
+ * INDIRECT, PUNITIVE OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA,
+ * COST OF PROCUREMENT OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY
+ * CLAIMS BY THIRD PARTIES (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF),
+ * OR OTHER SIMILAR COSTS.
+ *
+ * Date			Comment
+ *~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * 02/18/14		Estimates of bus time, frame rate and latency
+ *****************************************************************************/
+
+/*
+*****************************************************************************
+* Remarks: A pixel write goes through three stages that overlap: the MCU
+* writes bytes to SSD2805 over PMP or SPI, SSD2805 sends a MIPI packet as
+* soon as 0xBE bytes (or the rest of TDC) are in, and the panel writes the
+* packet into GRAM. The model takes the register settings of each stage
+* and returns the busy time of each, the latency of a draw sequence and
+* the frame rate it allows. It has no hardware access, this file and
+* SSD2805Timing.c build on a workstation as they are, so packet sizes,
+* clocks and batching can be compared before trying them on the board.
+* SSD2805GetTimingParams() of the driver fills the parameters in use.
+*
+* The model is a first order one: register writes elided by the driver
+* and the HS clock lane are not modelled. MCU time per bus cycle is the
+* longer of the PMP/SPI cycle and the CPU loop. With fifoBytes set the
+* MCU waits for the link to free room in the SSD2805 FIFO, a packet
+* leaves the FIFO once it is sent.
+*****************************************************************************
+*/
+#ifndef _SSD2805_TIMING_H
+#define _SSD2805_TIMING_H
+
+#include "GenericTypeDefs.h"
+
+// LP-11 to HS and back per HS packet: T_LPX + T_HS-PREPARE + T_HS-ZERO +
+// T_HS-TRAIL + T_HS-EXIT, about the D-PHY minimums at 320Mbps
+#ifndef SSD2805_EST_HS_TRANSITION_NS
+	#define SSD2805_EST_HS_TRANSITION_NS	400
+#endif
+
+// LP bit times per escape mode packet: entry sequence, LPDT command, exit
+#ifndef SSD2805_EST_LP_OVERHEAD_BITS
+	#define SSD2805_EST_LP_OVERHEAD_BITS	12
+#endif
+
+// Size of the SSD2805 write FIFO in bytes for the back pressure model,
+// check the datasheet of the part in use. 0 leaves back pressure out.
+#ifndef SSD2805_EST_FIFO_BYTES
+	#define SSD2805_EST_FIFO_BYTES			0
+#endif
+
+/*********************************************************************
+* Overview: Settings the estimate depends on. Register values are
+*			as written to SSD2805.
+*
+*********************************************************************/
+typedef struct
+{
+	DWORD	busClockHz;			// PMP peripheral bus clock, Tpb = 1/busClockHz
+	DWORD	spiClockHz;			// SPI clock, 0 for PMP
+	WORD	cpuNsPerCycle;		// CPU time per bus write in the driver loop
+	BYTE	waitB;				// PMMODE WAITB, WAITM and WAITE
+	BYTE	waitM;
+	BYTE	waitE;
+	BYTE	busBytes;			// bytes per bus write, 1 or 2 (16-bit PMP)
+	WORD	txClkMHz;			// SSD2805 TX_CLK, external oscillator
+	WORD	pllReg;				// 0xBA, PLL
+	WORD	clkCtrlReg;			// 0xBB, LP clock divider
+	WORD	configReg;			// 0xB7, HS (bit 0) and EOT (bit 9)
+	WORD	packetSize;			// 0xBE, bytes per packet, 0 for one packet per TDC
+	WORD	hsTransitionNs;		// SSD2805_EST_HS_TRANSITION_NS
+	WORD	panelNsPerByte;		// panel GRAM write time, 0 if it keeps up with the link
+	WORD	fifoBytes;			// SSD2805 write FIFO, 0 for no back pressure
+} SSD2805_TIMING_PARAMS;
+
+/*********************************************************************
+* Overview: Result of an estimate. Stage times are busy times, the
+*			stages overlap so latencyNs is less than their sum.
+*
+*********************************************************************/
+typedef struct
+{
+	DWORD	mcuNs;				// MCU interface, commands and addresses included
+	DWORD	stallNs;			// MCU waiting for FIFO room, not part of mcuNs
+	DWORD	linkNs;				// MIPI link, packet overhead and LP/HS changes included
+	DWORD	panelNs;			// panel GRAM writes
+	DWORD	latencyNs;			// first bus write to the last byte in GRAM
+	DWORD	packets;			// MIPI packets
+	DWORD	fpsX100;			// frames per second x100, sequence taken as one frame
+	BYTE	limit;				// stage bounding the throughput, SSD2805_EST_LIMIT_xxx
+} SSD2805_TIMING_ESTIMATE;
+
+#define SSD2805_EST_LIMIT_MCU		0
+#define SSD2805_EST_LIMIT_LINK		1
+#define SSD2805_EST_LIMIT_PANEL		2
+
+/*********************************************************************
+* Function: void SSD2805EstimateSequence(const SSD2805_TIMING_PARAMS *pParams,
+*						const DWORD *pBytes, WORD count,
+*						SSD2805_TIMING_ESTIMATE *pEst)
+*
+* Overview: estimates a draw sequence of 'count' memory writes, each
+*			with its own address window. pBytes[i] is the number of
+*			pixel bytes of write i, e.g. width*height*2 for RGB565.
+*			Fewer, larger writes save the window and packet overhead.
+*
+* Input: pParams - settings
+*		 pBytes - pixel bytes of each write
+*		 count - number of writes
+*		 pEst - result
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805EstimateSequence(const SSD2805_TIMING_PARAMS *pParams, const DWORD *pBytes, WORD count, SSD2805_TIMING_ESTIMATE *pEst);
+
+/*********************************************************************
+* Function: void SSD2805EstimateTransfer(const SSD2805_TIMING_PARAMS *pParams,
+*						DWORD bytes, SSD2805_TIMING_ESTIMATE *pEst)
+*
+* Overview: same as SSD2805EstimateSequence() for a single write
+*
+* Input: pParams - settings
+*		 bytes - pixel bytes
+*		 pEst - result
+*
+* Output: none
+*
+********************************************************************/
+void SSD2805EstimateTransfer(const SSD2805_TIMING_PARAMS *pParams, DWORD bytes, SSD2805_TIMING_ESTIMATE *pEst);
+
+#endif //_SSD2805_TIMING_H
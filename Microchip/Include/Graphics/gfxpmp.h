@@ -83,7 +83,9 @@
 * Side Effects: none
 *
 ********************************************************************/
+#ifndef PMPWaitBusy			// a driver may supply an instrumented version
 #define PMPWaitBusy()   while(PMMODEbits.BUSY); 
+#endif
 
 /*********************************************************************
  * Section: Deprecated Macros
@@ -165,6 +167,7 @@ extern inline void __attribute__ ((always_inline)) DisplayResetConfig()
 * Note: chip select should be enabled
 *
 ********************************************************************/
+#ifndef DeviceWrite			// a host build may supply a bus model
 #if defined (USE_16BIT_PMP)
 
 extern inline void __attribute__ ((always_inline)) DeviceWrite(WORD data) 
@@ -181,6 +184,7 @@ extern inline void __attribute__ ((always_inline)) DeviceWrite(BYTE data)
 	PMPWaitBusy();
 }
 
+#endif
 #endif
 
 /*********************************************************************
@@ -199,6 +203,7 @@ extern inline void __attribute__ ((always_inline)) DeviceWrite(BYTE data)
 * Note: chip select should be enabled
 *
 ********************************************************************/
+#ifndef DeviceRead
 #if defined (USE_16BIT_PMP)
 
 extern inline WORD __attribute__ ((always_inline)) DeviceRead()
@@ -227,6 +232,7 @@ BYTE value;
 }
 
 #endif
+#endif
 
 
 /*********************************************************************
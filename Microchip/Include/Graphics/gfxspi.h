@@ -0,0 +1,195 @@
+/*****************************************************************************
+ *  Module for Microchip Graphics Library
+ *  SPI driver for display controllers configured by serial interface
+ *****************************************************************************
+ * FileName:        gfxspi.h
+ * Processor:       PIC32
+ * Compiler:       	MPLAB C32/XC32
+ * Company:         TechToys Company
+ *
+ * Software License Agreement
+ *
+ * You should refer to the license agreement accompanying this Software
+ * for additional information regarding your rights and obligations.
+ *
+ * SOFTWARE AND DOCUMENTATION ARE PROVIDED "AS IS" WITHOUT WARRANTY OF ANY
+ * KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION, ANY WARRANTY
+ * OF MERCHANTABILITY, TITLE, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+ * PURPOSE. IN NO EVENT SHALL MICROCHIP OR ITS LICENSORS BE LIABLE OR
+ * OBLIGATED UNDER CONTRACT, NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION,
+ * BREACH OF WARRANTY, OR OTHER LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT
+ * DAMAGES OR EXPENSES INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL,
+ * INDIRECT, PUNITIVE OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA,
+ * COST OF PROCUREMENT OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY
+ * CLAIMS BY THIRD PARTIES (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF),
+ * OR OTHER SIMILAR COSTS.
+ *
+ * Date			Comment
+ *~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * 02/10/14		4-wire 8-bit SPI for SSD2805 in video mode
+ *****************************************************************************/
+#ifndef _GFX_SPI_H_FILE
+#define _GFX_SPI_H_FILE
+
+#include "HardwareProfile.h"
+#include "Compiler.h"
+#include "TimeDelay.h"
+
+#ifdef USE_GFX_SPI
+
+// Note:
+/*
+    Functions here keep the same names as gfxpmp.h so that the display
+    driver can use DeviceWrite()/DeviceRead() regardless of the interface.
+    The data/command line (SDC) and chip select are GPIO driven by
+    DisplaySetCommand()/DisplaySetData() and DisplayEnable()/DisplayDisable().
+*/
+
+    // error checking
+    #ifndef SSD_SPIBUF
+        #error "Define SSD_SPIBUF, SSD_SPICON, SSD_SPICONbits, SSD_SPISTATbits & SSD_SPIBRG in HardwareProfile.h"
+    #endif
+    #ifndef SSD_SPI_CLOCK_BEFORE_PLL
+        #error "Define SSD_SPI_CLOCK_BEFORE_PLL in HardwareProfile.h for SPI clock before SSD2805 PLL is locked"
+    #endif
+    #ifndef SSD_SPI_CLOCK
+        #error "Define SSD_SPI_CLOCK in HardwareProfile.h for SPI clock after SSD2805 PLL is locked"
+    #endif
+
+/*********************************************************************
+* Macros:  SPIWaitBusy()
+*
+* Overview: waits for the end of a SPI byte transfer. A byte is clocked
+*			in for every byte clocked out, SPIRBF is set when both ends
+*			of the exchange are complete.
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+#ifndef SPIWaitBusy			// a driver may supply an instrumented version
+#define SPIWaitBusy()   while(!SSD_SPISTATbits.SPIRBF);
+#endif
+
+/*********************************************************************
+* Macros:  DeviceWrite(data)
+*
+* PreCondition:  none
+*
+* Input: data - value to be written
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: writes a byte to the controller, the byte clocked in
+*			at the same time is discarded
+*
+* Note: chip select should be enabled
+*
+********************************************************************/
+extern inline void __attribute__ ((always_inline)) DeviceWrite(BYTE data)
+{
+	SSD_SPIBUF = data;
+	SPIWaitBusy();
+	data = SSD_SPIBUF;
+}
+
+/*********************************************************************
+* Macros:  DeviceRead()
+*
+* PreCondition:  none
+*
+* Input: none
+*
+* Output: data read
+*
+* Side Effects: none
+*
+* Overview: clocks a dummy byte out and returns the byte clocked in
+*
+* Note: chip select should be enabled
+*
+********************************************************************/
+extern inline BYTE __attribute__ ((always_inline)) DeviceRead()
+{
+	SSD_SPIBUF = 0x00;
+	SPIWaitBusy();
+	return (BYTE)SSD_SPIBUF;
+}
+
+/*********************************************************************
+* Macros:  SingleDeviceRead()
+*
+* Overview: same as DeviceRead(), SPI has no dummy read cycle
+*
+********************************************************************/
+#define SingleDeviceRead()  DeviceRead()
+
+/*********************************************************************
+* Function:  DriverInterfaceSetClock(DWORD clock)
+*
+* PreCondition:  DriverInterfaceInit()
+*
+* Input: clock - SPI clock in Hz
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: sets SPI clock to the nearest value not above 'clock'
+*
+* Note: SPIxBRG = Fpb/(2*Fsck) - 1
+*
+********************************************************************/
+extern inline void __attribute__ ((always_inline)) DriverInterfaceSetClock(DWORD clock)
+{
+	DWORD brg = (GetPeripheralClock() + 2*clock - 1)/(2*clock);
+
+	SSD_SPICONbits.ON = 0;
+	SSD_SPIBRG = (brg)? (brg - 1) : 0;
+	SSD_SPICONbits.ON = 1;
+}
+
+/*********************************************************************
+* Function:  DriverInterfaceInit()
+*
+* PreCondition:  none
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: initializes the SPI module as master, 8-bit, mode 0 (data
+*			sampled at rising edge of SCK, SCK idle low)
+*
+* Note: none
+*
+********************************************************************/
+extern inline void __attribute__ ((always_inline)) DriverInterfaceInit(void)
+{
+    DisplayCmdDataConfig();             // enable SDC line
+    DisplayDisable();                   // not selected by default
+    DisplayConfig();                    // enable chip select line
+
+    SSD_SPIPinConfig();
+
+    SSD_SPICON = 0;
+    SSD_SPIBUF;                         // clear receive buffer
+    SSD_SPICONbits.MSTEN = 1;           // master mode
+    SSD_SPICONbits.CKP = 0;             // SCK idle low
+    SSD_SPICONbits.CKE = 1;             // output changes on active to idle transition
+    SSD_SPICONbits.SMP = 0;             // input sampled at middle of data output time
+
+    DriverInterfaceSetClock(SSD_SPI_CLOCK_BEFORE_PLL);
+}
+
+#endif //#ifdef USE_GFX_SPI
+#endif //#ifndef _GFX_SPI_H_FILE
@@ -32,6 +32,8 @@ Date        Comments
 2009.10.14	FILE CREATED
 2009.10.15	CHANGED C18 DELAY ROUTINE TO DECREMENT ENTIRE NUMBER OF CYCLES
 2010.10.13  Added support for PICC compiler
+2014.02.12  Added core timer time service (timestamps, deadlines, yield hook)
+            for PIC32
 *******************************************************************************/
 
 #include "GenericTypeDefs.h"
@@ -78,3 +80,179 @@ void Delay10us( UINT32 tenMicroSecondCounter );
     None
   ***************************************************************************/
 void DelayMs( UINT16 ms );
+
+#if defined(__PIC32MX__)
+/****************************************************************************
+  Section:
+    Core timer time service (PIC32 only)
+
+  The core timer counts at SYSCLK/2 and wraps every 2^32 ticks (107s at
+  SYSCLK = 80MHz). Timestamps are taken from it directly so they cost a
+  single mfc0 instruction and are safe to read from interrupt handlers.
+  Deadlines are compared with a signed difference and so remain valid
+  across a wrap of the counter, as long as they are no more than half a
+  wrap period in the future.
+  ***************************************************************************/
+
+// core timer ticks per microsecond, GetSystemClock() from HardwareProfile.h
+#define TIME_TICKS_PER_US       (GetSystemClock()/2000000ul)
+#define TIME_TICKS_PER_MS       (GetSystemClock()/2000ul)
+
+typedef UINT32 TIME_DEADLINE;   // core timer value at which a wait ends
+
+/****************************************************************************
+  Function:
+    UINT32 TimeGetTicks( void )
+
+  Description:
+    This routine returns the raw core timer count.
+
+  Precondition:
+    None
+
+  Parameters:
+    None
+
+  Returns:
+    UINT32 - core timer count, TIME_TICKS_PER_US ticks per microsecond
+
+  Remarks:
+    Use the difference of two readings for intervals, wrap is harmless
+    for intervals shorter than a full wrap period.
+  ***************************************************************************/
+#define TimeGetTicks()          ((UINT32)ReadCoreTimer())
+
+/****************************************************************************
+  Function:
+    UINT32 TimeGetUs( void )
+
+  Description:
+    This routine returns a monotonic timestamp in microseconds.
+
+  Precondition:
+    None
+
+  Parameters:
+    None
+
+  Returns:
+    UINT32 - microseconds, wraps every 2^32 us (71 minutes)
+
+  Remarks:
+    The count is extended from the core timer, so it must be called at
+    least once per core timer wrap period to stay monotonic. Fractions of
+    a microsecond are carried over to the next call.
+  ***************************************************************************/
+UINT32 TimeGetUs( void );
+
+/****************************************************************************
+  Function:
+    TIME_DEADLINE TimeDeadlineUs( UINT32 us )
+
+  Description:
+    This routine returns a deadline 'us' microseconds from now.
+
+  Precondition:
+    None
+
+  Parameters:
+    UINT32 us - microseconds from now, less than half the core timer
+    wrap period
+
+  Returns:
+    TIME_DEADLINE - to be tested with TimeDeadlineExpired()
+
+  Remarks:
+    TimeDeadlineMs(ms) is the millisecond version.
+  ***************************************************************************/
+#define TimeDeadlineUs(us)      ((TIME_DEADLINE)(ReadCoreTimer() + (UINT32)(us)*TIME_TICKS_PER_US))
+#define TimeDeadlineMs(ms)      ((TIME_DEADLINE)(ReadCoreTimer() + (UINT32)(ms)*TIME_TICKS_PER_MS))
+
+/****************************************************************************
+  Function:
+    BOOL TimeDeadlineExpired( TIME_DEADLINE deadline )
+
+  Description:
+    This routine tells whether a deadline has been reached.
+
+  Precondition:
+    deadline from TimeDeadlineUs() or TimeDeadlineMs()
+
+  Parameters:
+    TIME_DEADLINE deadline - deadline to test
+
+  Returns:
+    TRUE once the deadline has been reached, FALSE before
+
+  Remarks:
+    None
+  ***************************************************************************/
+#define TimeDeadlineExpired(deadline)   ((INT32)(ReadCoreTimer() - (UINT32)(deadline)) >= 0)
+
+/****************************************************************************
+  Function:
+    void TimeSetYieldHook( void (*hook)(void) )
+
+  Description:
+    This routine registers the cooperative task hook called by TimeYield()
+    and DelayMsYield() while waiting.
+
+  Precondition:
+    None
+
+  Parameters:
+    void (*hook)(void) - task hook, NULL to remove it
+
+  Returns:
+    None
+
+  Remarks:
+    The hook is called from inside driver waits. It should return
+    quickly and must not call back into the code that is waiting, e.g.
+    the hook must not draw while the graphics driver waits for the panel.
+  ***************************************************************************/
+void TimeSetYieldHook( void (*hook)(void) );
+
+/****************************************************************************
+  Function:
+    void TimeYield( void )
+
+  Description:
+    This routine calls the yield hook once, if one is registered.
+
+  Precondition:
+    None
+
+  Parameters:
+    None
+
+  Returns:
+    None
+
+  Remarks:
+    Call it from the body of any polling loop.
+  ***************************************************************************/
+void TimeYield( void );
+
+/****************************************************************************
+  Function:
+    void DelayMsYield( UINT16 ms )
+
+  Description:
+    This routine waits 'ms' milliseconds on the core timer, calling the
+    yield hook repeatedly while waiting.
+
+  Precondition:
+    None
+
+  Parameters:
+    UINT16 ms - number of milliseconds to wait
+
+  Returns:
+    None
+
+  Remarks:
+    Same as DelayMs() when no yield hook is registered.
+  ***************************************************************************/
+void DelayMsYield( UINT16 ms );
+#endif